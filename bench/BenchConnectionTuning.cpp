@@ -0,0 +1,120 @@
+/*
+    Copyright (C) 2023  Paul Fotheringham (LinuxBrickie)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <benchmark/benchmark.h>
+
+#include <lb/url/Requester.h>
+
+#include "BenchServer.h"
+
+#include <future>
+#include <vector>
+
+
+// Benchmark argument to profile name, the empty name being the libcurl defaults.
+static const std::vector<std::string> profiles{ "", "lowLatency", "bulk" };
+
+static std::string profileLabel( const std::string& profile )
+{
+  return profile.empty() ? "default" : profile;
+}
+
+static lb::url::http::Response get( lb::url::Requester& requester, lb::url::http::Request request )
+{
+  std::promise<lb::url::http::Response> promise;
+  requester.makeRequest( std::move( request )
+                       , [ &promise ]( lb::url::ResponseCode rc, lb::url::http::Response r )
+  {
+    promise.set_value( std::move( r ) );
+  } );
+  return promise.get_future().get();
+}
+
+
+// Sequential tiny requests over a pooled connection, i.e. round trip latency.
+static void BM_TuningSmallRequestLatency( benchmark::State& state )
+{
+  const std::string& profile{ profiles.at( state.range( 0 ) ) };
+  state.SetLabel( profileLabel( profile ) );
+
+  lb::url::Requester::Config config;
+  config.tuningProfile = profile;
+  config.pollTimeoutMilliseconds = 1;
+  lb::url::Requester requester{ config };
+
+  for ( auto _ : state )
+  {
+    const auto response{ get( requester, { lb::url::http::Request::Method::eGet, benchUrl( benchSmallUrl ) } ) };
+    if ( response.code != 200 )
+    {
+      state.SkipWithError( "Request failed" );
+      break;
+    }
+  }
+  state.SetItemsProcessed( state.iterations() );
+}
+BENCHMARK( BM_TuningSmallRequestLatency )->DenseRange( 0, 2 )->UseRealTime();
+
+// Large downloads, i.e. receive throughput.
+static void BM_TuningDownloadThroughput( benchmark::State& state )
+{
+  const std::string& profile{ profiles.at( state.range( 0 ) ) };
+  state.SetLabel( profileLabel( profile ) );
+
+  lb::url::Requester::Config config;
+  config.tuningProfile = profile;
+  lb::url::Requester requester{ config };
+
+  for ( auto _ : state )
+  {
+    const auto response{ get( requester, { lb::url::http::Request::Method::eGet, benchUrl( benchLargeUrl ) } ) };
+    if ( response.content.size() != benchLargeNumBytes )
+    {
+      state.SkipWithError( "Request failed" );
+      break;
+    }
+  }
+  state.SetBytesProcessed( state.iterations() * benchLargeNumBytes );
+}
+BENCHMARK( BM_TuningDownloadThroughput )->DenseRange( 0, 2 )->UseRealTime();
+
+// Large uploads, i.e. send throughput.
+static void BM_TuningUploadThroughput( benchmark::State& state )
+{
+  const std::string& profile{ profiles.at( state.range( 0 ) ) };
+  state.SetLabel( profileLabel( profile ) );
+
+  lb::url::Requester::Config config;
+  config.tuningProfile = profile;
+  lb::url::Requester requester{ config };
+
+  const auto data{ std::make_shared<const std::string>( benchLargeNumBytes, 'x' ) };
+
+  for ( auto _ : state )
+  {
+    lb::url::http::Request request{ lb::url::http::Request::Method::ePut, benchUrl( benchUploadUrl ) };
+    request.body.sharedData = data;
+    const auto response{ get( requester, std::move( request ) ) };
+    if ( response.content != std::to_string( benchLargeNumBytes ) )
+    {
+      state.SkipWithError( "Request failed" );
+      break;
+    }
+  }
+  state.SetBytesProcessed( state.iterations() * benchLargeNumBytes );
+}
+BENCHMARK( BM_TuningUploadThroughput )->DenseRange( 0, 2 )->UseRealTime();
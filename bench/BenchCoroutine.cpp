@@ -0,0 +1,114 @@
+/*
+    Copyright (C) 2023  Paul Fotheringham (LinuxBrickie)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <benchmark/benchmark.h>
+
+#include <lb/url/Awaitable.h>
+
+#include "../gtest/AllocationCounter.h"
+#include "BenchServer.h"
+
+#include <coroutine>
+#include <exception>
+#include <future>
+
+
+// Sequential requests per benchmark iteration.
+static const size_t batchSize{ 100 };
+
+static lb::url::Requester::Config benchConfig()
+{
+  lb::url::Requester::Config config;
+  config.pollTimeoutMilliseconds = 1;
+  return config;
+}
+
+static lb::url::http::Request smallRequest()
+{
+  lb::url::http::Request request;
+  request.method = lb::url::http::Request::Method::eGet;
+  request.url = benchUrl( benchSmallUrl );
+  return request;
+}
+
+
+// Each request waits on its own promise/future, handing off from the
+// Requester thread to this one.
+static void BM_CallbackFuture( benchmark::State& state )
+{
+  lb::url::Requester requester{ benchConfig() };
+
+  size_t numAllocationsBefore{ numAllocations() };
+  for ( auto _ : state )
+  {
+    for ( size_t i = 0; i < batchSize; ++i )
+    {
+      std::promise<lb::url::http::Response> promise;
+      requester.makeRequest( smallRequest()
+                           , [ &promise ]( lb::url::ResponseCode rc, lb::url::http::Response r )
+      {
+        promise.set_value( std::move( r ) );
+      } );
+      benchmark::DoNotOptimize( promise.get_future().get() );
+    }
+  }
+  const size_t numRequests{ state.iterations() * batchSize };
+  state.counters[ "allocs/request" ] = double( numAllocations() - numAllocationsBefore ) / numRequests;
+  state.SetItemsProcessed( numRequests );
+}
+BENCHMARK( BM_CallbackFuture )->UseRealTime();
+
+
+struct Detached
+{
+  struct promise_type
+  {
+    Detached get_return_object() { return {}; }
+    std::suspend_never initial_suspend() noexcept { return {}; }
+    std::suspend_never final_suspend() noexcept { return {}; }
+    void return_void() {}
+    void unhandled_exception() { std::terminate(); }
+  };
+};
+
+static Detached getBatch( lb::url::Requester& requester, std::promise<void>& done )
+{
+  for ( size_t i = 0; i < batchSize; ++i )
+  {
+    benchmark::DoNotOptimize( co_await lb::url::awaitRequest( requester, smallRequest() ) );
+  }
+  done.set_value();
+}
+
+// Each request resumes the coroutine directly on the Requester thread.
+static void BM_Coroutine( benchmark::State& state )
+{
+  lb::url::Requester requester{ benchConfig() };
+
+  size_t numAllocationsBefore{ numAllocations() };
+  for ( auto _ : state )
+  {
+    std::promise<void> done;
+    auto future{ done.get_future() };
+    getBatch( requester, done );
+    future.get();
+  }
+  const size_t numRequests{ state.iterations() * batchSize };
+  state.counters[ "allocs/request" ] = double( numAllocations() - numAllocationsBefore ) / numRequests;
+  state.SetItemsProcessed( numRequests );
+}
+BENCHMARK( BM_Coroutine )->UseRealTime();
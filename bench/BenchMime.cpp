@@ -0,0 +1,115 @@
+/*
+    Copyright (C) 2023  Paul Fotheringham (LinuxBrickie)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <benchmark/benchmark.h>
+
+#include <lb/url/Requester.h>
+
+#include "BenchServer.h"
+
+#include <future>
+#include <memory>
+#include <string>
+
+
+// As the POSTMimeFormDataLarge test: a single large binary part.
+static const size_t mimeLargeNumBytes{ 256 * 1024 * 1024 };
+
+static lb::url::mime::MimePart largePart()
+{
+  lb::url::mime::MimePart part;
+  part.encoding = "binary";
+  part.name = "large";
+  return part;
+}
+
+static bool post( lb::url::Requester& requester, lb::url::mime::MimePart part )
+{
+  lb::url::http::Request request{ lb::url::http::Request::Method::ePost, benchUrl( benchUploadUrl ) };
+  request.mimePost.parts.push_back( std::move( part ) );
+
+  std::promise<lb::url::http::Response> promise;
+  requester.makeRequest( std::move( request )
+                       , [ &promise ]( lb::url::ResponseCode rc, lb::url::http::Response r )
+  {
+    promise.set_value( std::move( r ) );
+  } );
+  return promise.get_future().get().code == 200;
+}
+
+
+// The data is moved into the request.
+static void BM_MimeLargeData( benchmark::State& state )
+{
+  lb::url::Requester requester;
+
+  for ( auto _ : state )
+  {
+    state.PauseTiming();
+    auto part{ largePart() };
+    part.data = std::string( mimeLargeNumBytes, '0' );
+    state.ResumeTiming();
+
+    if ( !post( requester, std::move( part ) ) )
+    {
+      state.SkipWithError( "Request failed" );
+      break;
+    }
+  }
+  state.SetBytesProcessed( state.iterations() * mimeLargeNumBytes );
+}
+BENCHMARK( BM_MimeLargeData )->Unit( benchmark::kMillisecond )->UseRealTime();
+
+static void BM_MimeLargeSharedData( benchmark::State& state )
+{
+  lb::url::Requester requester;
+
+  const auto data{ std::make_shared<const std::string>( mimeLargeNumBytes, '0' ) };
+
+  for ( auto _ : state )
+  {
+    auto part{ largePart() };
+    part.sharedData = data;
+    if ( !post( requester, std::move( part ) ) )
+    {
+      state.SkipWithError( "Request failed" );
+      break;
+    }
+  }
+  state.SetBytesProcessed( state.iterations() * mimeLargeNumBytes );
+}
+BENCHMARK( BM_MimeLargeSharedData )->Unit( benchmark::kMillisecond )->UseRealTime();
+
+static void BM_MimeLargeDataView( benchmark::State& state )
+{
+  lb::url::Requester requester;
+
+  const std::string data( mimeLargeNumBytes, '0' );
+
+  for ( auto _ : state )
+  {
+    auto part{ largePart() };
+    part.dataView = data;
+    if ( !post( requester, std::move( part ) ) )
+    {
+      state.SkipWithError( "Request failed" );
+      break;
+    }
+  }
+  state.SetBytesProcessed( state.iterations() * mimeLargeNumBytes );
+}
+BENCHMARK( BM_MimeLargeDataView )->Unit( benchmark::kMillisecond )->UseRealTime();
@@ -0,0 +1,97 @@
+/*
+    Copyright (C) 2023  Paul Fotheringham (LinuxBrickie)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "BenchServer.h"
+
+#include <sstream>
+
+
+const std::string benchSmallUrl{ "/bench/small" };
+
+const std::string benchLargeUrl{ "/bench/large" };
+const size_t benchLargeNumBytes{ 16 * 1024 * 1024 };
+
+const std::string benchUploadUrl{ "/bench/upload" };
+
+const std::string benchWsStreamUrl{ "/bench/ws/stream" };
+
+
+std::string benchUrl( const std::string& path )
+{
+  return "http://localhost:" + std::to_string( benchServerPort ) + path;
+}
+
+std::string benchWsUrl( const std::string& path )
+{
+  return "ws://localhost:" + std::to_string( benchServerPort ) + path;
+}
+
+lb::httpd::Server::Response benchServerResponse( std::string url,
+                                                 lb::httpd::Server::Method method,
+                                                 lb::httpd::Server::Version version,
+                                                 lb::httpd::Server::Headers headers,
+                                                 std::string requestPayload,
+                                                 lb::httpd::Server::PostKeyValues postKeyValues )
+{
+  if ( url == benchSmallUrl )
+  {
+    return { 200, "ok" };
+  }
+  else if ( url == benchLargeUrl )
+  {
+    static const std::string large( benchLargeNumBytes, 'x' );
+    return { 200, large };
+  }
+  else if ( url == benchUploadUrl )
+  {
+    return { 200, std::to_string( requestPayload.size() ) };
+  }
+
+  return { 404, "Not found" };
+}
+
+static lb::httpd::ws::Receivers benchWsConnectionEstablished( lb::httpd::ws::Handler::Connection connection )
+{
+  const lb::httpd::ws::Senders senders{ connection.senders };
+  return {
+           [senders]( lb::httpd::ws::ConnectionID
+                    , lb::httpd::ws::Receivers::DataOpCode
+                    , std::string request )
+           {
+             size_t numBytes{ 0 };
+             size_t numMessages{ 0 };
+             std::istringstream{ request } >> numBytes >> numMessages;
+
+             const std::string message( numBytes, 'x' );
+             for ( size_t i = 0; i < numMessages; ++i )
+             {
+               senders.sendData( message, 0 );
+             }
+           },
+           []( lb::httpd::ws::ConnectionID
+             , lb::httpd::ws::Receivers::ControlOpCode
+             , std::string )
+           {
+           }
+         };
+}
+
+lb::httpd::ws::Handler benchWsHandler
+{
+  []( const std::string& urlPath ) { return urlPath == benchWsStreamUrl; },
+  benchWsConnectionEstablished
+};
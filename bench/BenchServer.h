@@ -0,0 +1,56 @@
+#ifndef LIB_LB_URL_BENCH_BENCHSERVER_H
+#define LIB_LB_URL_BENCH_BENCHSERVER_H
+
+/*
+    Copyright (C) 2023  Paul Fotheringham (LinuxBrickie)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <lb/httpd/Server.h>
+
+#include <string>
+
+
+//! The port the benchmark server listens on.
+const int benchServerPort{ 4100 };
+
+//! A tiny response, for measuring round trip latency.
+extern const std::string benchSmallUrl;
+
+//! A large response, for measuring download throughput.
+extern const std::string benchLargeUrl;
+extern const size_t benchLargeNumBytes;
+
+//! Responds with the size of the uploaded body, for measuring upload throughput.
+extern const std::string benchUploadUrl;
+
+//! WebSocket that, sent "<numBytes> <numMessages>", sends back that many
+//! messages of that size, for measuring receive throughput.
+extern const std::string benchWsStreamUrl;
+
+std::string benchUrl( const std::string& path );
+std::string benchWsUrl( const std::string& path );
+
+lb::httpd::Server::Response benchServerResponse( std::string url,
+                                                 lb::httpd::Server::Method,
+                                                 lb::httpd::Server::Version,
+                                                 lb::httpd::Server::Headers,
+                                                 std::string requestPayload,
+                                                 lb::httpd::Server::PostKeyValues );
+
+extern lb::httpd::ws::Handler benchWsHandler;
+
+
+#endif // LIB_LB_URL_BENCH_BENCHSERVER_H
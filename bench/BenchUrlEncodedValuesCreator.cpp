@@ -0,0 +1,110 @@
+/*
+    Copyright (C) 2023  Paul Fotheringham (LinuxBrickie)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <benchmark/benchmark.h>
+
+#include <lb/url/http/UrlEncodedValuesCreator.h>
+
+#include "../gtest/AllocationCounter.h"
+
+#include <curl/curl.h>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+
+// Fields like those of the POSTFormDataLarge test, with values of state.range( 0 )
+// bytes of which one in eight need encoding.
+static std::vector<std::string> formValues( size_t numBytes )
+{
+  std::vector<std::string> values;
+  for ( int i = 0; i < 1000; ++i )
+  {
+    std::string value;
+    for ( size_t j = 0; j < numBytes; ++j )
+    {
+      value += ( ( i + j ) % 8 == 0 ) ? ' ' : char( 'a' + ( i + j ) % 26 );
+    }
+    values.push_back( std::move( value ) );
+  }
+  return values;
+}
+
+
+// The previous implementation: curl_easy_escape into a std::stringstream.
+// Note that curl_easy_escape allocates with malloc, not operator new, so its
+// two allocations per field are not counted.
+static void BM_FormStringStream( benchmark::State& state )
+{
+  const auto values{ formValues( state.range( 0 ) ) };
+
+  size_t numBytes{ 0 };
+  const size_t numAllocationsBefore{ numAllocations() };
+  for ( auto _ : state )
+  {
+    std::stringstream ss;
+    bool empty{ true };
+    for ( size_t i = 0; i < values.size(); ++i )
+    {
+      if ( !empty )
+      {
+        ss << '&';
+      }
+      const std::string field{ "field#" + std::to_string( i ) };
+      char* escaped{ curl_easy_escape( nullptr, field.c_str(), field.size() ) };
+      ss << escaped << '=';
+      curl_free( escaped );
+      escaped = curl_easy_escape( nullptr, values[ i ].c_str(), values[ i ].size() );
+      ss << escaped;
+      curl_free( escaped );
+      empty = false;
+    }
+    const std::string data{ ss.str() };
+    numBytes += data.size();
+    benchmark::DoNotOptimize( data );
+  }
+  state.counters[ "allocs/field" ] = double( numAllocations() - numAllocationsBefore ) / ( state.iterations() * values.size() );
+  state.SetBytesProcessed( numBytes );
+}
+BENCHMARK( BM_FormStringStream )->Arg( 16 )->Arg( 256 )->Arg( 4096 );
+
+
+// The allocation per field counted here is the copy of the value into its
+// Encodable.
+static void BM_UrlEncodedValuesCreator( benchmark::State& state )
+{
+  const auto values{ formValues( state.range( 0 ) ) };
+
+  size_t numBytes{ 0 };
+  const size_t numAllocationsBefore{ numAllocations() };
+  for ( auto _ : state )
+  {
+    lb::url::http::UrlEncodedValuesCreator creator;
+    creator.reserve( values.size() * ( state.range( 0 ) * 5 / 4 + 16 ) );
+    for ( size_t i = 0; i < values.size(); ++i )
+    {
+      creator.add( { "field#" + std::to_string( i ) }, { values[ i ] } );
+    }
+    const std::string data{ std::move( creator ).str() };
+    numBytes += data.size();
+    benchmark::DoNotOptimize( data );
+  }
+  state.counters[ "allocs/field" ] = double( numAllocations() - numAllocationsBefore ) / ( state.iterations() * values.size() );
+  state.SetBytesProcessed( numBytes );
+}
+BENCHMARK( BM_UrlEncodedValuesCreator )->Arg( 16 )->Arg( 256 )->Arg( 4096 );
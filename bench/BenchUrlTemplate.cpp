@@ -0,0 +1,64 @@
+/*
+    Copyright (C) 2023  Paul Fotheringham (LinuxBrickie)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <benchmark/benchmark.h>
+
+#include <lb/url/UrlTemplate.h>
+
+#include "../gtest/AllocationCounter.h"
+
+#include <curl/curl.h>
+
+#include <sstream>
+#include <string>
+
+
+static const std::string userName{ "Zoë O'Brien" };
+static const int pageNumber{ 12 };
+
+
+// As the URL would be built with UrlEncodedValuesCreator's approach.
+static void BM_UrlStringStream( benchmark::State& state )
+{
+  const size_t numAllocationsBefore{ numAllocations() };
+  for ( auto _ : state )
+  {
+    std::ostringstream ss;
+    ss << "/v1/users/";
+    char* escaped{ curl_easy_escape( nullptr, userName.c_str(), userName.size() ) };
+    ss << escaped;
+    curl_free( escaped );
+    ss << "/items?page=" << pageNumber;
+    benchmark::DoNotOptimize( ss.str() );
+  }
+  state.counters[ "allocs/url" ] = double( numAllocations() - numAllocationsBefore ) / state.iterations();
+}
+BENCHMARK( BM_UrlStringStream );
+
+
+static void BM_UrlTemplate( benchmark::State& state )
+{
+  static constexpr lb::url::UrlTemplate userItems{ "/v1/users/{id}/items?page={n}" };
+
+  const size_t numAllocationsBefore{ numAllocations() };
+  for ( auto _ : state )
+  {
+    benchmark::DoNotOptimize( userItems.expand( userName, pageNumber ) );
+  }
+  state.counters[ "allocs/url" ] = double( numAllocations() - numAllocationsBefore ) / state.iterations();
+}
+BENCHMARK( BM_UrlTemplate );
@@ -0,0 +1,98 @@
+/*
+    Copyright (C) 2023  Paul Fotheringham (LinuxBrickie)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <benchmark/benchmark.h>
+
+#include <lb/url/Requester.h>
+
+#include "BenchServer.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <future>
+#include <mutex>
+#include <string>
+
+
+// Roughly this much is received per benchmark iteration, whatever the size of
+// the messages.
+static const size_t batchNumBytes{ 16 * 1024 * 1024 };
+
+
+// One connection receives a batch of messages of range(0) bytes, read with a
+// receive buffer of range(1) bytes.
+static void BM_WsReceive( benchmark::State& state )
+{
+  const size_t messageNumBytes{ size_t( state.range( 0 ) ) };
+  const size_t numMessages{ std::max( batchNumBytes / messageNumBytes, size_t( 1 ) ) };
+
+  std::mutex mutex;
+  std::condition_variable received;
+  size_t numReceived{ 0 };
+  size_t numBytesReceived{ 0 };
+
+  lb::url::ws::Request request{ benchWsUrl( benchWsStreamUrl )
+                              , { [&]( lb::url::ws::ConnectionID, lb::url::ws::DataOpCode, const std::string& message )
+                                  {
+                                    std::scoped_lock l{ mutex };
+                                    ++numReceived;
+                                    numBytesReceived += message.size();
+                                    received.notify_one();
+                                  }
+                                , []( lb::url::ws::ConnectionID, lb::url::ws::ControlOpCode, const std::string& )
+                                  {
+                                  } } };
+  request.receiveBufferSize = size_t( state.range( 1 ) );
+
+  lb::url::Requester::Config config;
+  config.pollTimeoutMilliseconds = 1;
+  lb::url::Requester requester{ config };
+
+  std::promise<lb::url::ws::Response> promise;
+  requester.makeRequest( std::move( request )
+                       , [&promise]( lb::url::ResponseCode rc, lb::url::ws::Response response )
+  {
+    promise.set_value( std::move( response ) );
+  } );
+  const auto response{ promise.get_future().get() };
+
+  const std::string command{ std::to_string( messageNumBytes ) + " " + std::to_string( numMessages ) };
+  for ( auto _ : state )
+  {
+    {
+      std::scoped_lock l{ mutex };
+      numReceived = 0;
+    }
+
+    response.senders.sendData( lb::url::ws::DataOpCode::eText, command );
+
+    std::unique_lock l{ mutex };
+    received.wait( l, [&]() { return numReceived == numMessages; } );
+  }
+
+  if ( numBytesReceived != state.iterations() * numMessages * messageNumBytes )
+  {
+    state.SkipWithError( "Messages received incomplete" );
+  }
+  state.SetItemsProcessed( state.iterations() * numMessages );
+  state.SetBytesProcessed( state.iterations() * numMessages * messageNumBytes );
+}
+BENCHMARK( BM_WsReceive )
+  ->ArgNames( { "messageBytes", "bufferBytes" } )
+  ->ArgsProduct( { { 1 << 10, 16 << 10, 64 << 10, 256 << 10, 1 << 20 }, { 256, 64 << 10 } } )
+  ->Unit( benchmark::kMillisecond )
+  ->UseRealTime();
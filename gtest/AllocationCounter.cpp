@@ -0,0 +1,59 @@
+/*
+    Copyright (C) 2023  Paul Fotheringham (LinuxBrickie)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "AllocationCounter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+
+static std::atomic<size_t> allocationCount{ 0 };
+static thread_local size_t threadAllocationCount{ 0 };
+
+
+size_t numAllocations()
+{
+  return allocationCount.load( std::memory_order_relaxed );
+}
+
+size_t numAllocationsOnThisThread()
+{
+  return threadAllocationCount;
+}
+
+
+void* operator new( size_t numBytes )
+{
+  allocationCount.fetch_add( 1, std::memory_order_relaxed );
+  ++threadAllocationCount;
+  if ( void* p{ std::malloc( numBytes ? numBytes : 1 ) } )
+  {
+    return p;
+  }
+  throw std::bad_alloc{};
+}
+
+void operator delete( void* p ) noexcept
+{
+  std::free( p );
+}
+
+void operator delete( void* p, size_t ) noexcept
+{
+  std::free( p );
+}
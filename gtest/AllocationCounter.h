@@ -0,0 +1,40 @@
+#ifndef LIB_LB_URL_GTEST_ALLOCATIONCOUNTER_H
+#define LIB_LB_URL_GTEST_ALLOCATIONCOUNTER_H
+
+/*
+    Copyright (C) 2023  Paul Fotheringham (LinuxBrickie)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <cstddef>
+
+
+/** \brief The number of calls to global operator new so far, across all
+           threads.
+
+    Linking AllocationCounter.cpp replaces global operator new to count them.
+    Shared by the gtests and the benchmarks.
+ */
+size_t numAllocations();
+
+/** \brief As \a numAllocations but only those made by the calling thread.
+
+    Counting per thread keeps the count free of allocations made by the
+    Requester thread, or any other, in the meantime.
+ */
+size_t numAllocationsOnThisThread();
+
+
+#endif // LIB_LB_URL_GTEST_ALLOCATIONCOUNTER_H
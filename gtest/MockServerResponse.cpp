@@ -21,6 +21,7 @@
 
 #include "TestHttpRequesterGet.h"
 #include "TestHttpRequesterPost.h"
+#include "TestHttpRequesterPut.h"
 
 lb::httpd::Server::Response createPostResponse( const std::string& url
                                               , const lb::httpd::Server::PostKeyValues keyValues )
@@ -109,6 +110,32 @@ lb::httpd::Server::Response mockServerResponse( std::string url,
     break;
   case lb::httpd::Server::Method::eGet:
   {
+    if ( url == GETRetryUrl )
+    {
+      response = GETRetryMockResponse();
+      break;
+    }
+    if ( url == GETHedgeUrl )
+    {
+      response = GETHedgeMockResponse();
+      break;
+    }
+    if ( url == GETSlowUrl )
+    {
+      response = GETSlowMockResponse();
+      break;
+    }
+    if ( url == GETLargeUrl )
+    {
+      response = GETLargeMockResponse();
+      break;
+    }
+    if ( url == GETHeadersUrl )
+    {
+      response = GETHeadersMockResponse( headers );
+      break;
+    }
+
     const auto I{ GETExpectedMockResponses.find( url ) };
     if ( I != GETExpectedMockResponses.end() )
     {
@@ -120,6 +147,12 @@ lb::httpd::Server::Response mockServerResponse( std::string url,
     break;
   case lb::httpd::Server::Method::ePost:
   {
+    if ( url == POSTEchoUrl )
+    {
+      response = { 200, std::move( requestPayload ) };
+      break;
+    }
+
     const auto I{ POSTTestData.find( url ) };
     if ( I != POSTTestData.end() )
     {
@@ -136,6 +169,10 @@ lb::httpd::Server::Response mockServerResponse( std::string url,
     break;
   }
   case lb::httpd::Server::Method::ePut:
+    if ( url == PUTEchoUrl )
+    {
+      response = PUTEchoMockResponse( std::move( requestPayload ) );
+    }
     break;
   case lb::httpd::Server::Method::eDelete:
     break;
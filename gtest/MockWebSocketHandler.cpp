@@ -50,6 +50,18 @@ void dataReceiver( lb::httpd::ws::ConnectionID id
   {
     WSInfo& wsInfo{ I->second };
 
+    if ( data == sendBurstMessage )
+    {
+      for ( size_t i = 0; i < numBurstMessages; ++i )
+      {
+        if ( wsInfo.dataSender.sendData( "Burst " + std::to_string( i ), 0 ) != lb::httpd::ws::SendResult::eSuccess )
+        {
+          std::cerr << "Failed to send data frame!" << std::endl;
+        }
+      }
+      return;
+    }
+
     const auto U{ WSExpectedMockResponses.find( wsInfo.url ) };
     if ( U != WSExpectedMockResponses.end() )
     {
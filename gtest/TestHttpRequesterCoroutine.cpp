@@ -0,0 +1,163 @@
+/*
+    Copyright (C) 2023  Paul Fotheringham (LinuxBrickie)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "TestHttpRequesterGet.h"
+
+#include <gtest/gtest.h>
+
+#include <condition_variable>
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <future>
+#include <mutex>
+#include <thread>
+
+#include <lb/url/Awaitable.h>
+
+#include "ServerList.h"
+
+
+// The simplest possible coroutine type, it just runs to completion.
+struct Detached
+{
+  struct promise_type
+  {
+    Detached get_return_object() { return {}; }
+    std::suspend_never initial_suspend() noexcept { return {}; }
+    std::suspend_never final_suspend() noexcept { return {}; }
+    void return_void() {}
+    void unhandled_exception() { std::terminate(); }
+  };
+};
+
+// Resumes coroutines on whichever thread calls run().
+class QueueExecutor
+{
+public:
+  void operator()( std::coroutine_handle<> coroutine )
+  {
+    std::scoped_lock l{ mutex };
+    queue.push_back( coroutine );
+    condition.notify_one();
+  }
+
+  void run( std::future<void>& until )
+  {
+    while ( until.wait_for( std::chrono::seconds( 0 ) ) != std::future_status::ready )
+    {
+      std::unique_lock l{ mutex };
+      if ( condition.wait_for( l, std::chrono::milliseconds( 10 ), [this] { return !queue.empty(); } ) )
+      {
+        const auto coroutine{ queue.front() };
+        queue.pop_front();
+        l.unlock();
+        coroutine.resume();
+      }
+    }
+  }
+
+private:
+  std::mutex mutex;
+  std::condition_variable condition;
+  std::deque< std::coroutine_handle<> > queue;
+};
+
+
+static Detached getAll( lb::url::Requester& requester, int port, std::promise<void>& done )
+{
+  for ( const auto&[ urlPath, expectedResponse ] : GETExpectedMockResponses )
+  {
+    lb::url::http::Request request;
+    request.method = lb::url::http::Request::Method::eGet;
+    request.url = "http://" + hostColonPort( port ) + urlPath;
+
+    const auto result{ co_await lb::url::awaitRequest( requester, std::move( request ) ) };
+
+    EXPECT_EQ( result.responseCode, lb::url::ResponseCode::eSuccess );
+    EXPECT_EQ( result.response.code, expectedResponse.code );
+    EXPECT_EQ( result.response.content, expectedResponse.content );
+  }
+
+  done.set_value();
+}
+
+static Detached getOnExecutor( lb::url::Requester& requester
+                             , int port
+                             , QueueExecutor& executor
+                             , std::thread::id& resumedOn
+                             , std::promise<void>& done )
+{
+  const auto&[ urlPath, expectedResponse ]{ *GETExpectedMockResponses.begin() };
+
+  lb::url::http::Request request;
+  request.method = lb::url::http::Request::Method::eGet;
+  request.url = "http://" + hostColonPort( port ) + urlPath;
+
+  const auto result{ co_await lb::url::awaitRequest( requester, std::move( request ), std::ref( executor ) ) };
+  resumedOn = std::this_thread::get_id();
+
+  EXPECT_EQ( result.response.content, expectedResponse.content );
+
+  done.set_value();
+}
+
+static Detached sendWithoutConnection( lb::url::ws::SendResult& result, size_t& numExecuted )
+{
+  auto countingExecutor = [&numExecuted]( std::coroutine_handle<> coroutine )
+  {
+    ++numExecuted;
+    coroutine.resume();
+  };
+  result = co_await lb::url::awaitSendData( lb::url::ws::Senders{}, lb::url::ws::DataOpCode::eText, "Hello", countingExecutor );
+}
+
+
+TEST(Http, RequesterCoroutine)
+{
+  const int port{ serverList.at( httpd::ServerType::eBasic ).front().port };
+
+  lb::url::Requester requester;
+
+  // Resumed inline on the Requester thread.
+  {
+    std::promise<void> done;
+    auto future{ done.get_future() };
+    getAll( requester, port, done );
+    EXPECT_EQ( future.wait_for( std::chrono::seconds( 10 ) ), std::future_status::ready );
+  }
+
+  // Resumed on this thread.
+  {
+    QueueExecutor executor;
+    std::thread::id resumedOn;
+    std::promise<void> done;
+    auto future{ done.get_future() };
+    getOnExecutor( requester, port, executor, resumedOn, done );
+    executor.run( future );
+    EXPECT_EQ( resumedOn, std::this_thread::get_id() );
+  }
+
+  // Completes before even suspending so carries on without the executor.
+  {
+    lb::url::ws::SendResult result{ lb::url::ws::SendResult::eSuccess };
+    size_t numExecuted{ 0 };
+    sendWithoutConnection( result, numExecuted );
+    EXPECT_EQ( result, lb::url::ws::SendResult::eNoImplementation );
+    EXPECT_EQ( numExecuted, 0 );
+  }
+}
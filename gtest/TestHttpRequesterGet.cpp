@@ -19,11 +19,17 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <atomic>
 #include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 #include <lb/url/Requester.h>
 
 #include "ServerList.h"
+#include "../src/http/PreparedRequestImpl.h"
 
 
 const std::unordered_map<std::string, lb::httpd::Server::Response> GETExpectedMockResponses
@@ -79,6 +85,63 @@ const std::unordered_map<std::string, lb::httpd::Server::Response> GETExpectedMo
   },
 };
 
+const std::string GETRetryUrl{ "/test/url/http/get/retry" };
+
+lb::httpd::Server::Response GETRetryMockResponse()
+{
+  static std::atomic<int> numRequests{ 0 };
+  if ( ++numRequests % 3 != 0 )
+  {
+    return { 503, "GET test response SERVICE UNAVAILABLE" };
+  }
+  return { 200, "GET test response SUCCESS after retries" };
+}
+
+const std::string GETHedgeUrl{ "/test/url/http/get/hedge" };
+
+lb::httpd::Server::Response GETHedgeMockResponse()
+{
+  static std::atomic<int> numRequests{ 0 };
+  if ( ++numRequests % 2 != 0 )
+  {
+    std::this_thread::sleep_for( std::chrono::milliseconds( 1000 ) );
+  }
+  return { 200, "GET test response SUCCESS for hedge" };
+}
+
+const std::string GETSlowUrl{ "/test/url/http/get/slow" };
+
+lb::httpd::Server::Response GETSlowMockResponse()
+{
+  std::this_thread::sleep_for( std::chrono::milliseconds( 200 ) );
+  return { 200, "GET test response SUCCESS eventually" };
+}
+
+const std::string GETLargeUrl{ "/test/url/http/get/large" };
+const size_t GETLargeNumBytes{ 4 * 1024 * 1024 };
+
+lb::httpd::Server::Response GETLargeMockResponse()
+{
+  return { 200, std::string( GETLargeNumBytes, 'x' ) };
+}
+
+const std::string GETHeadersUrl{ "/test/url/http/get/headers" };
+
+lb::httpd::Server::Response GETHeadersMockResponse( const lb::httpd::Server::Headers& headers )
+{
+  std::string content;
+  for ( const auto& [ name, value ] : headers )
+  {
+    std::string lowerName{ name };
+    std::transform( lowerName.begin(), lowerName.end(), lowerName.begin(), ::tolower );
+    if ( lowerName.rfind( "x-test", 0 ) == 0 )
+    {
+      content += lowerName + ": " + value + "\n";
+    }
+  }
+  return { 200, std::move( content ) };
+}
+
 
 TEST(Http, RequesterGet)
 {
@@ -107,3 +170,642 @@ TEST(Http, RequesterGet)
     }
   }
 }
+
+TEST(Http, RequesterGetRetry)
+{
+  lb::url::Requester requester;
+
+  for ( auto&[type, serverConfigs] : serverList )
+  {
+    for ( const auto serverConfig : serverConfigs )
+    {
+      std::promise< std::pair< lb::url::ResponseCode
+                             , lb::url::http::Response > > promise;
+
+      lb::url::http::Request request{ lb::url::http::Request::Method::eGet
+                                    , "http://" + hostColonPort( serverConfig.port ) + GETRetryUrl };
+      request.retryPolicy.maxAttempts = 3;
+      request.retryPolicy.initialBackoffMilliseconds = 10;
+
+      requester.makeRequest( request
+                           , [ &promise ]( lb::url::ResponseCode rc, lb::url::http::Response r )
+      {
+        promise.set_value( { rc, std::move( r ) } );
+      } );
+
+      const auto actualResponse{ promise.get_future().get() };
+
+      EXPECT_EQ( actualResponse.first              , lb::url::ResponseCode::eSuccess );
+      EXPECT_EQ( actualResponse.second.code        , 200 );
+      EXPECT_EQ( actualResponse.second.content     , "GET test response SUCCESS after retries" );
+      EXPECT_EQ( actualResponse.second.numAttempts , 3 );
+    }
+  }
+
+  // A status code that is not retryable is responded to immediately.
+  {
+    std::promise<lb::url::http::Response> promise;
+
+    lb::url::http::Request request{ lb::url::http::Request::Method::eGet
+                                  , "http://" + hostColonPort( serverList.at( httpd::ServerType::eBasic ).front().port )
+                                  + "/test/url/http/get404" };
+    request.retryPolicy.maxAttempts = 3;
+
+    requester.makeRequest( request
+                         , [ &promise ]( lb::url::ResponseCode rc, lb::url::http::Response r )
+    {
+      promise.set_value( std::move( r ) );
+    } );
+
+    const lb::url::http::Response actualResponse{ promise.get_future().get() };
+
+    EXPECT_EQ( actualResponse.code       , 404 );
+    EXPECT_EQ( actualResponse.numAttempts, 1 );
+  }
+}
+
+TEST(Http, RequesterGetHedge)
+{
+  lb::url::Requester::Config config;
+  config.hedging.maxFraction = 1.0;
+  lb::url::Requester requester{ config };
+
+  std::promise< std::pair< lb::url::ResponseCode
+                         , lb::url::http::Response > > promise;
+
+  lb::url::http::Request request{ lb::url::http::Request::Method::eGet
+                                , "http://" + hostColonPort( serverList.at( httpd::ServerType::eBasic ).front().port )
+                                + GETHedgeUrl };
+  request.hedgePolicy.delayMilliseconds = 50;
+
+  requester.makeRequest( request
+                       , [ &promise ]( lb::url::ResponseCode rc, lb::url::http::Response r )
+  {
+    promise.set_value( { rc, std::move( r ) } );
+  } );
+
+  const auto actualResponse{ promise.get_future().get() };
+
+  EXPECT_EQ( actualResponse.first         , lb::url::ResponseCode::eSuccess );
+  EXPECT_EQ( actualResponse.second.code   , 200 );
+  EXPECT_EQ( actualResponse.second.content, "GET test response SUCCESS for hedge" );
+
+  // Whether the hedge wins depends on whether the server can handle requests
+  // concurrently so only check that it was made.
+  const auto statistics{ requester.getHedgeStatistics() };
+  EXPECT_EQ( statistics.numHedged, 1 );
+  EXPECT_EQ( statistics.numDenied, 0 );
+}
+
+TEST(Http, RequesterGetPriority)
+{
+  lb::url::Requester::Config config;
+  config.maxConcurrentRequests = 1;
+  lb::url::Requester requester{ config };
+
+  const std::string baseUrl{ "http://" + hostColonPort( serverList.at( httpd::ServerType::eBasic ).front().port ) };
+
+  std::mutex mutex;
+  std::vector<std::string> completionOrder;
+  std::vector< std::promise<void> > promises( 5 );
+
+  const auto makeRequest = [&]( std::string name, std::string urlPath, lb::url::Priority priority, size_t index )
+  {
+    lb::url::http::Request request{ lb::url::http::Request::Method::eGet, baseUrl + urlPath };
+    request.priority = priority;
+
+    requester.makeRequest( request
+                         , [ &, name, index ]( lb::url::ResponseCode rc, lb::url::http::Response r )
+    {
+      {
+        std::scoped_lock l{ mutex };
+        completionOrder.push_back( name );
+      }
+      promises[ index ].set_value();
+    } );
+  };
+
+  // The slow request occupies the only slot whilst the rest queue up behind it.
+  makeRequest( "slow", GETSlowUrl              , lb::url::Priority::eNormal, 0 );
+  makeRequest( "low1", "/test/url/http/get200" , lb::url::Priority::eLow   , 1 );
+  makeRequest( "low2", "/test/url/http/get200" , lb::url::Priority::eLow   , 2 );
+  makeRequest( "low3", "/test/url/http/get200" , lb::url::Priority::eLow   , 3 );
+  makeRequest( "high", "/test/url/http/get200" , lb::url::Priority::eHigh  , 4 );
+
+  for ( auto& promise : promises )
+  {
+    promise.get_future().wait();
+  }
+
+  // The high priority request overtakes all the low priority ones.
+  const auto high{ std::find( completionOrder.begin(), completionOrder.end(), "high" ) };
+  ASSERT_NE( high, completionOrder.end() );
+  for ( const std::string low : { "low1", "low2", "low3" } )
+  {
+    EXPECT_LT( high, std::find( completionOrder.begin(), completionOrder.end(), low ) );
+  }
+}
+
+TEST(Http, RequesterGetHostLimits)
+{
+  const int port{ serverList.at( httpd::ServerType::eBasic ).front().port };
+
+  // Token bucket: one request immediately then one every 100 milliseconds.
+  {
+    lb::url::Requester::Config config;
+    config.hostLimits[ "localhost" ].requestsPerSecond = 10.0;
+    lb::url::Requester requester{ config };
+
+    const size_t numRequests{ 5 };
+    std::vector< std::promise<lb::url::http::Response> > promises( numRequests );
+
+    const auto start{ std::chrono::steady_clock::now() };
+    for ( auto& promise : promises )
+    {
+      requester.makeRequest( { lb::url::http::Request::Method::eGet
+                             , "http://" + hostColonPort( port ) + "/test/url/http/get200" }
+                           , [ &promise ]( lb::url::ResponseCode rc, lb::url::http::Response r )
+      {
+        promise.set_value( std::move( r ) );
+      } );
+    }
+
+    size_t maxQueueWaitMicroseconds{ 0 };
+    for ( auto& promise : promises )
+    {
+      const auto response{ promise.get_future().get() };
+      EXPECT_EQ( response.code, 200 );
+      maxQueueWaitMicroseconds = std::max( maxQueueWaitMicroseconds, response.queueWaitMicroseconds );
+    }
+    const auto elapsed{ std::chrono::steady_clock::now() - start };
+
+    EXPECT_GE( elapsed, std::chrono::milliseconds( 350 ) );
+    EXPECT_GE( maxQueueWaitMicroseconds, 300000 );
+  }
+
+  // Concurrency: the second request waits for the first to finish.
+  {
+    lb::url::Requester::Config config;
+    config.defaultHostLimits.maxConcurrentRequests = 1;
+    lb::url::Requester requester{ config };
+
+    std::vector< std::promise<lb::url::http::Response> > promises( 2 );
+    for ( auto& promise : promises )
+    {
+      requester.makeRequest( { lb::url::http::Request::Method::eGet
+                             , "http://" + hostColonPort( port ) + GETSlowUrl }
+                           , [ &promise ]( lb::url::ResponseCode rc, lb::url::http::Response r )
+      {
+        promise.set_value( std::move( r ) );
+      } );
+    }
+
+    const auto first { promises[ 0 ].get_future().get() };
+    const auto second{ promises[ 1 ].get_future().get() };
+    EXPECT_EQ( first.code , 200 );
+    EXPECT_EQ( second.code, 200 );
+    EXPECT_GE( std::max( first.queueWaitMicroseconds, second.queueWaitMicroseconds ), 150000 );
+  }
+}
+
+TEST(Http, RequesterGetHostLimitsRetryHedge)
+{
+  const int port{ serverList.at( httpd::ServerType::eBasic ).front().port };
+
+  // Each retry waits for a token so three attempts take at least 200
+  // milliseconds rather than the 20 milliseconds of backoff.
+  {
+    lb::url::Requester::Config config;
+    config.hostLimits[ "localhost" ].requestsPerSecond = 10.0;
+    lb::url::Requester requester{ config };
+
+    std::promise<lb::url::http::Response> promise;
+
+    lb::url::http::Request request{ lb::url::http::Request::Method::eGet
+                                  , "http://" + hostColonPort( port ) + GETRetryUrl };
+    request.retryPolicy.maxAttempts = 3;
+    request.retryPolicy.initialBackoffMilliseconds = 10;
+
+    const auto start{ std::chrono::steady_clock::now() };
+    requester.makeRequest( request
+                         , [ &promise ]( lb::url::ResponseCode rc, lb::url::http::Response r )
+    {
+      promise.set_value( std::move( r ) );
+    } );
+
+    const auto response{ promise.get_future().get() };
+    const auto elapsed{ std::chrono::steady_clock::now() - start };
+
+    EXPECT_EQ( response.code       , 200 );
+    EXPECT_EQ( response.numAttempts, 3 );
+    EXPECT_GE( elapsed, std::chrono::milliseconds( 190 ) );
+  }
+
+  // A hedge is not issued whilst the host is at its concurrency limit.
+  {
+    lb::url::Requester::Config config;
+    config.hedging.maxFraction = 1.0;
+    config.hostLimits[ "localhost" ].maxConcurrentRequests = 1;
+    lb::url::Requester requester{ config };
+
+    std::promise<lb::url::http::Response> promise;
+
+    lb::url::http::Request request{ lb::url::http::Request::Method::eGet
+                                  , "http://" + hostColonPort( port ) + GETSlowUrl };
+    request.hedgePolicy.delayMilliseconds = 50;
+
+    requester.makeRequest( request
+                         , [ &promise ]( lb::url::ResponseCode rc, lb::url::http::Response r )
+    {
+      promise.set_value( std::move( r ) );
+    } );
+
+    EXPECT_EQ( promise.get_future().get().code, 200 );
+
+    const auto statistics{ requester.getHedgeStatistics() };
+    EXPECT_EQ( statistics.numHedged, 0 );
+    EXPECT_EQ( statistics.numDenied, 1 );
+  }
+
+  // Likewise when the host has no rate limit token.
+  {
+    lb::url::Requester::Config config;
+    config.hedging.maxFraction = 1.0;
+    config.hostLimits[ "localhost" ].requestsPerSecond = 1.0;
+    lb::url::Requester requester{ config };
+
+    std::promise<lb::url::http::Response> promise;
+
+    lb::url::http::Request request{ lb::url::http::Request::Method::eGet
+                                  , "http://" + hostColonPort( port ) + GETSlowUrl };
+    request.hedgePolicy.delayMilliseconds = 50;
+
+    requester.makeRequest( request
+                         , [ &promise ]( lb::url::ResponseCode rc, lb::url::http::Response r )
+    {
+      promise.set_value( std::move( r ) );
+    } );
+
+    EXPECT_EQ( promise.get_future().get().code, 200 );
+
+    const auto statistics{ requester.getHedgeStatistics() };
+    EXPECT_EQ( statistics.numHedged, 0 );
+    EXPECT_EQ( statistics.numDenied, 1 );
+  }
+}
+
+TEST(Http, RequesterGetCancel)
+{
+  const int port{ serverList.at( httpd::ServerType::eBasic ).front().port };
+
+  lb::url::Requester::Config config;
+  config.maxConcurrentRequests = 1;
+  lb::url::Requester requester{ config };
+
+  struct Result
+  {
+    std::promise<lb::url::ResponseCode> promise;
+    std::atomic<int> numCallbacks{ 0 };
+  };
+
+  auto makeRequest = [&]( Result& result )
+  {
+    return requester.makeRequest( { lb::url::http::Request::Method::eGet
+                                  , "http://" + hostColonPort( port ) + GETSlowUrl }
+                                , [ &result ]( lb::url::ResponseCode rc, lb::url::http::Response r )
+    {
+      if ( result.numCallbacks++ == 0 )
+      {
+        result.promise.set_value( rc );
+      }
+    } );
+  };
+
+  Result inFlight, queued, completed;
+  auto inFlightHandle { makeRequest( inFlight ) };
+  auto queuedHandle   { makeRequest( queued ) };
+  auto completedHandle{ makeRequest( completed ) };
+
+  // The second request is still waiting for the first to finish.
+  queuedHandle.cancel();
+  EXPECT_EQ( queued.promise.get_future().get(), lb::url::ResponseCode::eAborted );
+
+  std::this_thread::sleep_for( std::chrono::milliseconds( 50 ) );
+  inFlightHandle.cancel();
+  inFlightHandle.cancel();
+  EXPECT_EQ( inFlight.promise.get_future().get(), lb::url::ResponseCode::eAborted );
+
+  // Cancelling after completion does nothing.
+  EXPECT_EQ( completed.promise.get_future().get(), lb::url::ResponseCode::eSuccess );
+  completedHandle.cancel();
+
+  std::this_thread::sleep_for( std::chrono::milliseconds( 300 ) );
+  EXPECT_EQ( inFlight.numCallbacks, 1 );
+  EXPECT_EQ( queued.numCallbacks, 1 );
+  EXPECT_EQ( completed.numCallbacks, 1 );
+
+  // A default constructed handle is harmless.
+  lb::url::RequestHandle{}.cancel();
+}
+
+TEST(Http, RequesterGetBodySink)
+{
+  const int port{ serverList.at( httpd::ServerType::eBasic ).front().port };
+
+  lb::url::Requester requester;
+
+  // Pause on the first chunk then resume from this thread.
+  std::atomic<size_t> numChunks{ 0 };
+  std::atomic<size_t> numBytes{ 0 };
+  std::atomic<bool> pause{ true };
+
+  lb::url::http::Request request{ lb::url::http::Request::Method::eGet
+                                , "http://" + hostColonPort( port ) + GETLargeUrl };
+  request.bodySink = [&]( std::string_view data )
+  {
+    ++numChunks;
+    if ( pause.exchange( false ) )
+    {
+      return lb::url::http::Request::SinkStatus::ePause;
+    }
+    numBytes += data.size();
+    return lb::url::http::Request::SinkStatus::eContinue;
+  };
+
+  std::promise<lb::url::http::Response> promise;
+  auto future{ promise.get_future() };
+  auto handle
+  {
+    requester.makeRequest( std::move( request )
+                         , [ &promise ]( lb::url::ResponseCode rc, lb::url::http::Response r )
+    {
+      EXPECT_EQ( rc, lb::url::ResponseCode::eSuccess );
+      promise.set_value( std::move( r ) );
+    } )
+  };
+
+  EXPECT_EQ( future.wait_for( std::chrono::milliseconds( 300 ) ), std::future_status::timeout );
+  EXPECT_EQ( numChunks, 1 );
+
+  handle.resume();
+
+  const auto response{ future.get() };
+  EXPECT_EQ( response.code, 200 );
+  EXPECT_TRUE( response.content.empty() );
+  EXPECT_EQ( numBytes, GETLargeNumBytes );
+}
+
+TEST(Http, RequesterGetReceiveWatermarks)
+{
+  const int port{ serverList.at( httpd::ServerType::eBasic ).front().port };
+
+  // Low enough that transfers are paused but progress must still be made.
+  lb::url::Requester::Config config;
+  config.receiveWatermarks.highBytes = GETLargeNumBytes / 4;
+  config.receiveWatermarks.lowBytes  = GETLargeNumBytes / 8;
+  lb::url::Requester requester{ config };
+
+  std::vector< std::promise<lb::url::http::Response> > promises( 4 );
+  for ( auto& promise : promises )
+  {
+    requester.makeRequest( { lb::url::http::Request::Method::eGet
+                           , "http://" + hostColonPort( port ) + GETLargeUrl }
+                         , [ &promise ]( lb::url::ResponseCode rc, lb::url::http::Response r )
+    {
+      EXPECT_EQ( rc, lb::url::ResponseCode::eSuccess );
+      promise.set_value( std::move( r ) );
+    } );
+  }
+
+  for ( auto& promise : promises )
+  {
+    const auto response{ promise.get_future().get() };
+    EXPECT_EQ( response.code, 200 );
+    EXPECT_EQ( response.content.size(), GETLargeNumBytes );
+  }
+}
+
+TEST(Http, RequesterGetTuning)
+{
+  const int port{ serverList.at( httpd::ServerType::eBasic ).front().port };
+
+  lb::url::Requester::Config config;
+  config.tuningProfile = "lowLatency";
+  lb::url::Requester requester{ config };
+
+  auto get = [&]( std::string profile, lb::url::ConnectionTuning tuning )
+  {
+    lb::url::http::Request request{ lb::url::http::Request::Method::eGet
+                                  , "http://" + hostColonPort( port ) + GETLargeUrl };
+    request.tuningProfile = std::move( profile );
+    request.tuning = std::move( tuning );
+
+    std::promise<lb::url::http::Response> promise;
+    requester.makeRequest( std::move( request )
+                         , [ &promise ]( lb::url::ResponseCode rc, lb::url::http::Response r )
+    {
+      EXPECT_EQ( rc, lb::url::ResponseCode::eSuccess );
+      promise.set_value( std::move( r ) );
+    } );
+    return promise.get_future().get();
+  };
+
+  // The Config profile, a per-request profile and a per-request override.
+  lb::url::ConnectionTuning smallBuffer;
+  smallBuffer.receiveBufferSize = 1024;
+  for ( const auto& response : { get( {}, {} ), get( "bulk", {} ), get( "bulk", smallBuffer ) } )
+  {
+    EXPECT_EQ( response.code, 200 );
+    EXPECT_EQ( response.content.size(), GETLargeNumBytes );
+  }
+
+  EXPECT_THROW( get( "unknown", {} ), std::runtime_error );
+}
+
+TEST(Http, RequesterGetPrewarm)
+{
+  const int port{ serverList.at( httpd::ServerType::eBasic ).front().port };
+
+  lb::url::Requester requester;
+
+  EXPECT_TRUE( requester.prewarm( {} ).get().hosts.empty() );
+
+  auto future{ requester.prewarm( { hostColonPort( port ), "http://no-such-host.invalid" }, 2 ) };
+  ASSERT_EQ( future.wait_for( std::chrono::seconds( 10 ) ), std::future_status::ready );
+
+  const auto result{ future.get() };
+  ASSERT_EQ( result.hosts.size(), 2 );
+  EXPECT_EQ( result.hosts[ 0 ].host, hostColonPort( port ) );
+  EXPECT_EQ( result.hosts[ 0 ].numConnections, 2 );
+  EXPECT_FALSE( result.hosts[ 0 ].pinnedAddresses.empty() );
+  EXPECT_EQ( result.hosts[ 1 ].numConnections, 0 );
+  EXPECT_TRUE( result.hosts[ 1 ].pinnedAddresses.empty() );
+
+  // Requests to the pinned host still work.
+  const auto&[ urlPath, expectedResponse ]{ *GETExpectedMockResponses.begin() };
+  std::promise<lb::url::http::Response> promise;
+  requester.makeRequest( { lb::url::http::Request::Method::eGet
+                         , "http://" + hostColonPort( port ) + urlPath }
+                       , [ &promise ]( lb::url::ResponseCode rc, lb::url::http::Response r )
+  {
+    promise.set_value( std::move( r ) );
+  } );
+
+  const auto response{ promise.get_future().get() };
+  EXPECT_EQ( response.code   , expectedResponse.code );
+  EXPECT_EQ( response.content, expectedResponse.content );
+
+  // A Requester destroyed first still makes the future ready. The address is
+  // not routable so the connection is still being attempted.
+  std::future<lb::url::Requester::PrewarmResult> abandoned;
+  {
+    lb::url::Requester shortLived;
+    abandoned = shortLived.prewarm( { "http://10.255.255.1:81" } );
+  }
+  ASSERT_EQ( abandoned.wait_for( std::chrono::seconds( 0 ) ), std::future_status::ready );
+  const auto abandonedResult{ abandoned.get() };
+  ASSERT_EQ( abandonedResult.hosts.size(), 1 );
+  EXPECT_EQ( abandonedResult.hosts[ 0 ].numConnections, 0 );
+  EXPECT_TRUE( abandonedResult.hosts[ 0 ].pinnedAddresses.empty() );
+}
+
+TEST(Http, RequesterGetCompletions)
+{
+  const int port{ serverList.at( httpd::ServerType::eBasic ).front().port };
+
+  // Small enough that completions overflow the ring.
+  lb::url::Requester::Config config;
+  config.completionQueueCapacity = 4;
+  lb::url::Requester requester{ config };
+
+  lb::url::Requester::Completion completion;
+  EXPECT_EQ( requester.pollCompletions( &completion, 1, std::chrono::milliseconds( 0 ) ), 0 );
+
+  std::vector< const std::pair<const std::string, lb::httpd::Server::Response>* > expected;
+  for ( size_t i = 0; i < 32; ++i )
+  {
+    for ( const auto& urlPathAndResponse : GETExpectedMockResponses )
+    {
+      requester.makeRequest( { lb::url::http::Request::Method::eGet
+                             , "http://" + hostColonPort( port ) + urlPathAndResponse.first }
+                           , expected.size() );
+      expected.push_back( &urlPathAndResponse );
+    }
+  }
+
+  // Drain from several threads at once.
+  std::mutex mutex;
+  std::vector<size_t> numPerTag( expected.size(), 0 );
+  std::atomic<size_t> numCompleted{ 0 };
+  std::vector<std::thread> workers;
+  for ( size_t w = 0; w < 3; ++w )
+  {
+    workers.emplace_back( [&]()
+    {
+      std::vector<lb::url::Requester::Completion> batch( 8 );
+      const auto deadline{ std::chrono::steady_clock::now() + std::chrono::seconds( 20 ) };
+      while ( ( numCompleted < expected.size() ) && ( std::chrono::steady_clock::now() < deadline ) )
+      {
+        const size_t n{ requester.pollCompletions( batch.data(), batch.size(), std::chrono::milliseconds( 50 ) ) };
+        for ( size_t i = 0; i < n; ++i )
+        {
+          ASSERT_LT( batch[ i ].tag, expected.size() );
+          EXPECT_EQ( batch[ i ].responseCode, lb::url::ResponseCode::eSuccess );
+          EXPECT_EQ( batch[ i ].response.code, expected[ batch[ i ].tag ]->second.code );
+          EXPECT_EQ( batch[ i ].response.content, expected[ batch[ i ].tag ]->second.content );
+          std::scoped_lock l{ mutex };
+          ++numPerTag[ batch[ i ].tag ];
+        }
+        numCompleted += n;
+      }
+    } );
+  }
+  for ( auto& worker : workers )
+  {
+    worker.join();
+  }
+
+  EXPECT_EQ( numCompleted, expected.size() );
+  EXPECT_TRUE( std::all_of( numPerTag.begin(), numPerTag.end(), []( size_t n ) { return n == 1; } ) );
+}
+
+TEST(Http, RequesterGetPrepared)
+{
+  const int port{ serverList.at( httpd::ServerType::eBasic ).front().port };
+
+  lb::url::http::Request prototype{ lb::url::http::Request::Method::eGet
+                                  , "http://" + hostColonPort( port ) + "/test/url/http?a=1#ignored"
+                                  , { "X-Test-One: 1", "X-Test-Two: 2" } };
+  const lb::url::http::PreparedRequest prepared{ prototype };
+  EXPECT_TRUE( prepared );
+  EXPECT_FALSE( lb::url::http::PreparedRequest{} );
+
+  // The URL that would be sent, without building it as a string first.
+  auto sentUrl = [&]( const lb::url::http::Request& request )
+  {
+    EXPECT_TRUE( request.url.empty() );
+    std::string url;
+    CURLU* copy{ lb::url::http::PreparedRequest::Impl::get( prepared )->url( request.prepared ) };
+    char* part{ nullptr };
+    if ( copy && ( curl_url_get( copy, CURLUPART_URL, &part, 0 ) == CURLUE_OK ) )
+    {
+      url = part;
+      curl_free( part );
+    }
+    curl_url_cleanup( copy );
+    return url;
+  };
+  EXPECT_EQ( sentUrl( prepared.create( "get200", "b=2" ) ), "http://" + hostColonPort( port ) + "/test/url/http/get200?a=1&b=2" );
+  EXPECT_EQ( sentUrl( prepared.create( "/get200" ) ), "http://" + hostColonPort( port ) + "/test/url/http/get200?a=1" );
+  EXPECT_EQ( sentUrl( prepared.create() ), "http://" + hostColonPort( port ) + "/test/url/http?a=1" );
+
+  // The body of the prototype is not copied.
+  lb::url::http::Request postPrototype{ lb::url::http::Request::Method::ePost, "http://" + hostColonPort( port ) };
+  postPrototype.postUrlEncodedValues = "fruit=apple";
+  postPrototype.body.data = "data";
+  const auto post{ lb::url::http::PreparedRequest{ postPrototype }.create() };
+  EXPECT_EQ( post.method, lb::url::http::Request::Method::ePost );
+  EXPECT_TRUE( post.postUrlEncodedValues.empty() );
+  EXPECT_TRUE( post.body.data.empty() );
+
+  EXPECT_THROW( lb::url::http::PreparedRequest( lb::url::http::Request{ lb::url::http::Request::Method::eGet, "http://bad host" } )
+              , std::runtime_error );
+
+  lb::url::Requester requester;
+
+  auto get = [&]( lb::url::http::Request request )
+  {
+    std::promise<lb::url::http::Response> promise;
+    requester.makeRequest( std::move( request )
+                         , [ &promise ]( lb::url::ResponseCode rc, lb::url::http::Response r )
+    {
+      EXPECT_EQ( rc, lb::url::ResponseCode::eSuccess );
+      promise.set_value( std::move( r ) );
+    } );
+    return promise.get_future().get();
+  };
+
+  // Created on several threads at once.
+  std::vector<std::future<lb::url::http::Response>> responses;
+  for ( int i = 0; i < 8; ++i )
+  {
+    responses.push_back( std::async( std::launch::async, [&]{ return get( prepared.create( "get200" ) ); } ) );
+  }
+  for ( auto& response : responses )
+  {
+    const auto r{ response.get() };
+    EXPECT_EQ( r.code, 200 );
+    EXPECT_EQ( r.content, "GET test response SUCCESS" );
+  }
+
+  // The prepared headers, with and without extra ones.
+  EXPECT_EQ( get( prepared.create( "get/headers" ) ).content, "x-test-one: 1\nx-test-two: 2\n" );
+  auto withExtra{ prepared.create( "get/headers" ) };
+  withExtra.headers.push_back( "X-Test-Extra: 3" );
+  EXPECT_EQ( get( std::move( withExtra ) ).content, "x-test-extra: 3\nx-test-one: 1\nx-test-two: 2\n" );
+
+  // A changed URL is still sent, just not using the prepared one.
+  auto changed{ prepared.create() };
+  changed.url = "http://" + hostColonPort( port ) + GETLargeUrl;
+  EXPECT_EQ( get( std::move( changed ) ).content.size(), GETLargeNumBytes );
+}
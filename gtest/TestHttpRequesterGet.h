@@ -27,5 +27,25 @@
 //! Keyed by URL path
 extern const std::unordered_map<std::string, lb::httpd::Server::Response> GETExpectedMockResponses;
 
+//! Fails with 503 on all but every third request
+extern const std::string GETRetryUrl;
+lb::httpd::Server::Response GETRetryMockResponse();
+
+//! Responds slowly to every other request
+extern const std::string GETHedgeUrl;
+lb::httpd::Server::Response GETHedgeMockResponse();
+
+//! Always responds slowly
+extern const std::string GETSlowUrl;
+lb::httpd::Server::Response GETSlowMockResponse();
+
+//! Responds with a body large enough to arrive in many chunks
+extern const std::string GETLargeUrl;
+lb::httpd::Server::Response GETLargeMockResponse();
+
+//! Responds with the X-Test headers of the request, one per line
+extern const std::string GETHeadersUrl;
+lb::httpd::Server::Response GETHeadersMockResponse( const lb::httpd::Server::Headers& );
+
 
 #endif // LIB_LB_URL_GTEST_TESTREQUESTERHTTPGET_H
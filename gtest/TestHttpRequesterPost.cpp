@@ -18,8 +18,19 @@
 #include "TestHttpRequesterPost.h"
 
 #include <gtest/gtest.h>
+#include <cstring>
 
+#include <fstream>
 #include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <zlib.h>
+
+#include <fcntl.h>
+#include <unistd.h>
 
 #include "ServerList.h"
 
@@ -54,6 +65,7 @@ const std::string POSTMimeFormDataSimple{ "/test/url/http/post/mime/form/simple"
 const std::string POSTMimeFormDataContainsNull{ "/test/url/http/post/mime/form/contains-null" };
 const std::string POSTMimeFormDataLarge{ "/test/url/http/post/mime/form/large" };
 const std::string POSTMimeFormDataMulti{ "/test/url/http/post/mime/form/multi" };
+const std::string POSTEchoUrl{ "/test/url/http/post/echo" };
 
 
 std::string POSTFormDataUrlNoEncodingDataString()
@@ -476,3 +488,380 @@ TEST(Http, RequesterPost)
   }
 }
 
+
+TEST(Http, RequesterPostStream)
+{
+  const int port{ serverList.at( httpd::ServerType::eBasic ).front().port };
+
+  lb::url::Requester requester;
+
+  const auto stream{ lb::url::http::BodyStream::create() };
+
+  lb::url::http::Request request{ lb::url::http::Request::Method::ePost, baseUrl( port ) + POSTEchoUrl };
+  request.headers.push_back( "Content-Type: application/x-ndjson" );
+  request.body.stream = stream;
+
+  std::promise< std::pair< lb::url::ResponseCode, lb::url::http::Response > > promise;
+  requester.makeRequest( std::move( request )
+                       , [ &promise ]( lb::url::ResponseCode rc, lb::url::http::Response r )
+  {
+    promise.set_value( { rc, std::move( r ) } );
+  } );
+
+  // The producer is slower than the transfer so it will be paused between
+  // each write.
+  std::string expected;
+  std::thread producer{ [&stream, &expected]()
+  {
+    for ( int i = 0; i < 20; ++i )
+    {
+      std::string line{ "{\"line\":" + std::to_string( i ) + "}\n" };
+      expected += line;
+      EXPECT_TRUE( stream.write( std::move( line ) ) );
+      std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+    }
+    stream.finish();
+    EXPECT_FALSE( stream.write( "too late" ) );
+  } };
+
+  const auto actualResponse{ promise.get_future().get() };
+  producer.join();
+
+  ASSERT_EQ( actualResponse.first         , lb::url::ResponseCode::eSuccess );
+  EXPECT_EQ( actualResponse.second.code   , 200 );
+  EXPECT_EQ( actualResponse.second.content, expected );
+  EXPECT_EQ( stream.numBufferedBytes(), 0 );
+}
+
+
+static std::string gunzip( const std::string& compressed )
+{
+  z_stream stream{};
+  if ( inflateInit2( &stream, 15 + 16 ) != Z_OK )
+  {
+    return {};
+  }
+
+  std::string decompressed;
+  char buffer[ 16384 ];
+  stream.next_in = (Bytef*)compressed.data();
+  stream.avail_in = uInt( compressed.size() );
+  int rc{ Z_OK };
+  while ( rc == Z_OK )
+  {
+    stream.next_out = (Bytef*)buffer;
+    stream.avail_out = sizeof( buffer );
+    rc = inflate( &stream, Z_NO_FLUSH );
+    decompressed.append( buffer, sizeof( buffer ) - stream.avail_out );
+  }
+  inflateEnd( &stream );
+
+  return ( rc == Z_STREAM_END ) ? decompressed : std::string{};
+}
+
+TEST(Http, RequesterPostCompressed)
+{
+  const int port{ serverList.at( httpd::ServerType::eBasic ).front().port };
+
+  lb::url::Requester requester;
+
+  auto post = [&]( lb::url::http::Request request )
+  {
+    request.method = lb::url::http::Request::Method::ePost;
+    request.url = baseUrl( port ) + POSTEchoUrl;
+
+    std::promise< std::pair< lb::url::ResponseCode, lb::url::http::Response > > promise;
+    requester.makeRequest( std::move( request )
+                         , [ &promise ]( lb::url::ResponseCode rc, lb::url::http::Response r )
+    {
+      promise.set_value( { rc, std::move( r ) } );
+    } );
+    return promise.get_future().get();
+  };
+
+  std::string telemetry;
+  for ( int i = 0; i < 10000; ++i )
+  {
+    telemetry += "metric" + std::to_string( i % 10 ) + "=" + std::to_string( i ) + "&";
+  }
+
+  // URL encoded values.
+  {
+    lb::url::http::Request request;
+    request.postUrlEncodedValues = telemetry;
+    request.compression.encoding = lb::url::http::Request::Compression::Encoding::eGzip;
+    const auto[rc, response]{ post( std::move( request ) ) };
+    ASSERT_EQ( rc, lb::url::ResponseCode::eSuccess );
+    EXPECT_EQ( response.code, 200 );
+    EXPECT_EQ( gunzip( response.content ), telemetry );
+    EXPECT_EQ( response.uncompressedBodyNumBytes, telemetry.size() );
+    EXPECT_EQ( response.compressedBodyNumBytes, response.content.size() );
+    EXPECT_LT( response.compressedBodyNumBytes, telemetry.size() / 4 );
+  }
+
+  // Below the threshold so sent as-is.
+  {
+    lb::url::http::Request request;
+    request.postUrlEncodedValues = "small=1";
+    request.compression.encoding = lb::url::http::Request::Compression::Encoding::eGzip;
+    const auto[rc, response]{ post( std::move( request ) ) };
+    ASSERT_EQ( rc, lb::url::ResponseCode::eSuccess );
+    EXPECT_EQ( response.content, "small=1" );
+    EXPECT_EQ( response.uncompressedBodyNumBytes, 0 );
+    EXPECT_EQ( response.compressedBodyNumBytes, 0 );
+  }
+
+  // A stream, flushed each time the producer pauses.
+  {
+    const auto stream{ lb::url::http::BodyStream::create() };
+
+    lb::url::http::Request request;
+    request.body.stream = stream;
+    request.compression.encoding = lb::url::http::Request::Compression::Encoding::eGzip;
+
+    std::thread producer{ [&stream, &telemetry]()
+    {
+      for ( size_t i = 0; i < telemetry.size(); i += 10000 )
+      {
+        stream.write( telemetry.substr( i, 10000 ) );
+        std::this_thread::sleep_for( std::chrono::milliseconds( 5 ) );
+      }
+      stream.finish();
+    } };
+
+    const auto[rc, response]{ post( std::move( request ) ) };
+    producer.join();
+    ASSERT_EQ( rc, lb::url::ResponseCode::eSuccess );
+    EXPECT_EQ( gunzip( response.content ), telemetry );
+    EXPECT_EQ( response.uncompressedBodyNumBytes, telemetry.size() );
+  }
+
+  // Each MIME part is compressed individually.
+  {
+    lb::url::http::Request request;
+    request.mimePost.parts.push_back( { "text/plain", "", "telemetry", telemetry } );
+    request.compression.encoding = lb::url::http::Request::Compression::Encoding::eGzip;
+    const auto[rc, response]{ post( std::move( request ) ) };
+    ASSERT_EQ( rc, lb::url::ResponseCode::eSuccess );
+    EXPECT_NE( response.content.find( "Content-Encoding: gzip" ), std::string::npos );
+    EXPECT_EQ( response.uncompressedBodyNumBytes, telemetry.size() );
+    EXPECT_LT( response.compressedBodyNumBytes, telemetry.size() / 4 );
+  }
+
+  if ( lb::url::http::Request::Compression::isSupported( lb::url::http::Request::Compression::Encoding::eZstd ) )
+  {
+    lb::url::http::Request request;
+    request.body.data = telemetry;
+    request.compression.encoding = lb::url::http::Request::Compression::Encoding::eZstd;
+    const auto[rc, response]{ post( std::move( request ) ) };
+    ASSERT_EQ( rc, lb::url::ResponseCode::eSuccess );
+    ASSERT_GE( response.content.size(), 4 );
+    EXPECT_EQ( response.content.substr( 0, 4 ), std::string( "\x28\xb5\x2f\xfd" ) );
+    EXPECT_EQ( response.uncompressedBodyNumBytes, telemetry.size() );
+    EXPECT_EQ( response.compressedBodyNumBytes, response.content.size() );
+  }
+}
+
+TEST(Http, RequesterPostMimeShared)
+{
+  const int port{ serverList.at( httpd::ServerType::eBasic ).front().port };
+
+  lb::url::Requester requester;
+
+  const auto shared{ std::make_shared<const std::string>( 100000, 's' ) };
+  const std::string viewed( 50000, 'v' );
+
+  // Several requests share the same data, none of them copying it.
+  std::vector< std::future<lb::url::http::Response> > responses;
+  for ( int i = 0; i < 4; ++i )
+  {
+    lb::url::http::Request request{ lb::url::http::Request::Method::ePost, baseUrl( port ) + POSTEchoUrl };
+    request.mimePost.parts.resize( 3 );
+    request.mimePost.parts[ 0 ].name = "owned";
+    request.mimePost.parts[ 0 ].data = "owned data " + std::to_string( i );
+    request.mimePost.parts[ 1 ].name = "shared";
+    request.mimePost.parts[ 1 ].sharedData = shared;
+    request.mimePost.parts[ 2 ].name = "viewed";
+    request.mimePost.parts[ 2 ].dataView = viewed;
+
+    auto promise{ std::make_shared< std::promise<lb::url::http::Response> >() };
+    responses.push_back( promise->get_future() );
+    requester.makeRequest( std::move( request )
+                         , [ promise ]( lb::url::ResponseCode rc, lb::url::http::Response r )
+    {
+      EXPECT_EQ( rc, lb::url::ResponseCode::eSuccess );
+      promise->set_value( std::move( r ) );
+    } );
+  }
+
+  for ( int i = 0; i < 4; ++i )
+  {
+    const auto response{ responses[ i ].get() };
+    EXPECT_EQ( response.code, 200 );
+    EXPECT_NE( response.content.find( "name=\"owned\"\r\n\r\nowned data " + std::to_string( i ) + "\r\n" ), std::string::npos );
+    EXPECT_NE( response.content.find( "name=\"shared\"\r\n\r\n" + *shared + "\r\n" ), std::string::npos );
+    EXPECT_NE( response.content.find( "name=\"viewed\"\r\n\r\n" + viewed + "\r\n" ), std::string::npos );
+  }
+}
+
+TEST(Http, RequesterPostMimeFile)
+{
+  const int port{ serverList.at( httpd::ServerType::eBasic ).front().port };
+
+  std::string contents;
+  for ( int i = 0; contents.size() < 3000000; ++i )
+  {
+    contents += "line " + std::to_string( i ) + "\n";
+  }
+  char path[]{ "/tmp/lbUrlMimeFileXXXXXX" };
+  const int tmpFd{ mkstemp( path ) };
+  ASSERT_GE( tmpFd, 0 );
+  ::close( tmpFd );
+  std::ofstream{ path, std::ios::binary } << contents;
+  const std::string baseName{ std::string{ path }.substr( 5 ) };
+
+  lb::url::Requester requester;
+
+  auto post = [&]( lb::url::mime::MimePart part )
+  {
+    lb::url::http::Request request{ lb::url::http::Request::Method::ePost, baseUrl( port ) + POSTEchoUrl };
+    request.mimePost.parts.push_back( std::move( part ) );
+
+    auto promise{ std::make_shared< std::promise<lb::url::http::Response> >() };
+    auto future{ promise->get_future() };
+    requester.makeRequest( std::move( request )
+                         , [ promise ]( lb::url::ResponseCode rc, lb::url::http::Response r )
+    {
+      EXPECT_EQ( rc, lb::url::ResponseCode::eSuccess );
+      promise->set_value( std::move( r ) );
+    } );
+    return future;
+  };
+
+  // The whole file, named after its path.
+  {
+    lb::url::mime::MimePart part;
+    part.name = "upload";
+    part.file.path = path;
+    const auto response{ post( std::move( part ) ).get() };
+    EXPECT_EQ( response.code, 200 );
+    EXPECT_NE( response.content.find( "name=\"upload\"; filename=\"" + baseName + "\"" ), std::string::npos );
+    EXPECT_NE( response.content.find( "\r\n\r\n" + contents + "\r\n" ), std::string::npos );
+  }
+
+  // A region from a descriptor that is closed as soon as the request is made,
+  // with an explicit file name, with pread and memory mapped.
+  for ( const bool memoryMap : { false, true } )
+  {
+    lb::url::mime::MimePart part;
+    part.name = "region";
+    part.file.fd = ::open( path, O_RDONLY );
+    ASSERT_GE( part.file.fd, 0 );
+    part.file.offset = 5000;
+    part.file.numBytes = 100000;
+    part.file.memoryMap = memoryMap;
+    part.file.fileName = "region.txt";
+    const int fd{ part.file.fd };
+    auto future{ post( std::move( part ) ) };
+    ::close( fd );
+    const auto response{ future.get() };
+    EXPECT_EQ( response.code, 200 );
+    EXPECT_NE( response.content.find( "name=\"region\"; filename=\"region.txt\"" ), std::string::npos );
+    EXPECT_NE( response.content.find( "\r\n\r\n" + contents.substr( 5000, 100000 ) + "\r\n" ), std::string::npos );
+  }
+
+  // Files that cannot be used are reported to the request maker.
+  {
+    lb::url::mime::MimePart missing;
+    missing.file.path = "/tmp/lbUrlNoSuchFile";
+    EXPECT_THROW( post( std::move( missing ) ), std::runtime_error );
+
+    lb::url::mime::MimePart beyondEnd;
+    beyondEnd.file.path = path;
+    beyondEnd.file.offset = contents.size() + 1;
+    EXPECT_THROW( post( std::move( beyondEnd ) ), std::runtime_error );
+  }
+
+  ::unlink( path );
+}
+
+TEST(Http, RequesterPostMimePaused)
+{
+  const int port{ serverList.at( httpd::ServerType::eBasic ).front().port };
+
+  std::string contents;
+  for ( int i = 0; contents.size() < 200000; ++i )
+  {
+    contents += "chunk " + std::to_string( i ) + "\n";
+  }
+
+  // Written to by the producer and read from by the reader, which pauses
+  // rather than blocking whenever it has caught up.
+  struct Shared
+  {
+    std::mutex mutex;
+    std::string available;
+    size_t offset{ 0 };
+    size_t numPauses{ 0 };
+  };
+  const auto shared{ std::make_shared<Shared>() };
+
+  lb::url::mime::MimePart part;
+  part.name = "relayed";
+  part.dataReader.totalNumBytes = contents.size();
+  part.dataReader.dataReadFn = [shared]( char* buffer, size_t numBytes )
+  {
+    std::scoped_lock l{ shared->mutex };
+    if ( shared->offset == shared->available.size() )
+    {
+      ++shared->numPauses;
+      return lb::url::mime::MimePart::DataReader::rcReadPause;
+    }
+    numBytes = std::min( numBytes, shared->available.size() - shared->offset );
+    std::memcpy( buffer, shared->available.data() + shared->offset, numBytes );
+    shared->offset += numBytes;
+    return numBytes;
+  };
+  part.dataReader.dataSeekFn = [shared]( size_t offset, int origin )
+  {
+    std::scoped_lock l{ shared->mutex };
+    shared->offset = offset;
+    return int( lb::url::mime::MimePart::DataReader::rcSeekOk );
+  };
+
+  lb::url::http::Request request{ lb::url::http::Request::Method::ePost, baseUrl( port ) + POSTEchoUrl };
+  request.mimePost.parts.push_back( std::move( part ) );
+
+  lb::url::Requester requester;
+
+  std::promise<lb::url::http::Response> promise;
+  auto future{ promise.get_future() };
+  const auto handle{ requester.makeRequest( std::move( request )
+                                          , [&promise]( lb::url::ResponseCode rc, lb::url::http::Response r )
+  {
+    EXPECT_EQ( rc, lb::url::ResponseCode::eSuccess );
+    promise.set_value( std::move( r ) );
+  } ) };
+
+  std::thread producer{ [&contents, shared, handle]()
+  {
+    for ( size_t i = 0; i < contents.size(); i += 10000 )
+    {
+      std::this_thread::sleep_for( std::chrono::milliseconds( 5 ) );
+      {
+        std::scoped_lock l{ shared->mutex };
+        shared->available += contents.substr( i, 10000 );
+      }
+      handle.resume();
+    }
+  } };
+
+  ASSERT_EQ( future.wait_for( std::chrono::seconds( 10 ) ), std::future_status::ready );
+  producer.join();
+  const auto response{ future.get() };
+  EXPECT_EQ( response.code, 200 );
+  EXPECT_NE( response.content.find( "name=\"relayed\"\r\n\r\n" + contents + "\r\n" ), std::string::npos );
+
+  std::scoped_lock l{ shared->mutex };
+  EXPECT_GT( shared->numPauses, 0 );
+}
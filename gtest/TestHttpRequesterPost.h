@@ -48,5 +48,8 @@ extern const std::string POSTMimeFormDataContainsNull;
 extern const std::string POSTMimeFormDataLarge;
 extern const std::string POSTMimeFormDataMulti;
 
+//! Responds with the request body
+extern const std::string POSTEchoUrl;
+
 
 #endif // TESTREQUESTERHTTPPOST_H
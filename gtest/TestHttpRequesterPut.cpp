@@ -0,0 +1,246 @@
+/*
+    Copyright (C) 2023  Paul Fotheringham (LinuxBrickie)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "TestHttpRequesterPut.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <lb/url/Requester.h>
+
+#include "ServerList.h"
+
+
+const std::string PUTEchoUrl{ "/test/url/http/put/echo" };
+
+lb::httpd::Server::Response PUTEchoMockResponse( std::string requestPayload )
+{
+  return { 200, std::move( requestPayload ) };
+}
+
+
+static std::string largeBody()
+{
+  std::string body( 1024 * 1024, '\0' );
+  for ( size_t i = 0; i < body.size(); ++i )
+  {
+    body[ i ] = char( 'a' + i % 26 );
+  }
+  return body;
+}
+
+
+static size_t numOpenFds()
+{
+  const std::filesystem::directory_iterator fds{ "/proc/self/fd" };
+  return size_t( std::distance( begin( fds ), end( fds ) ) );
+}
+
+
+/** \brief A DataReader that reads from \a source, optionally without a size. */
+static lb::url::mime::MimePart::DataReader reader( std::shared_ptr<const std::string> source )
+{
+  auto offset{ std::make_shared<size_t>( 0 ) };
+
+  lb::url::mime::MimePart::DataReader dataReader;
+  dataReader.dataReadFn = [source, offset]( char* buffer, size_t numBytes )
+  {
+    // Deliberately small reads to exercise many calls.
+    numBytes = std::min( { numBytes, size_t( 1000 ), source->size() - *offset } );
+    std::memcpy( buffer, source->data() + *offset, numBytes );
+    *offset += numBytes;
+    return numBytes;
+  };
+  dataReader.dataSeekFn = [offset]( size_t o, int origin )
+  {
+    *offset = o;
+    return int( lb::url::mime::MimePart::DataReader::rcSeekOk );
+  };
+  dataReader.totalNumBytes = source->size();
+  return dataReader;
+}
+
+
+TEST(Http, RequesterPut)
+{
+  const int port{ serverList.at( httpd::ServerType::eBasic ).front().port };
+  const std::string url{ "http://" + hostColonPort( port ) + PUTEchoUrl };
+
+  lb::url::Requester requester;
+
+  auto put = [&]( lb::url::http::Body body )
+  {
+    lb::url::http::Request request{ lb::url::http::Request::Method::ePut, url };
+    request.body = std::move( body );
+
+    std::promise< std::pair< lb::url::ResponseCode, lb::url::http::Response > > promise;
+    requester.makeRequest( std::move( request )
+                         , [ &promise ]( lb::url::ResponseCode rc, lb::url::http::Response r )
+    {
+      promise.set_value( { rc, std::move( r ) } );
+    } );
+    return promise.get_future().get();
+  };
+
+  const auto expected{ std::make_shared<const std::string>( largeBody() ) };
+
+  {
+    lb::url::http::Body body;
+    body.data = *expected;
+    const auto[rc, response]{ put( std::move( body ) ) };
+    ASSERT_EQ( rc, lb::url::ResponseCode::eSuccess );
+    EXPECT_EQ( response.code, 200 );
+    EXPECT_EQ( response.content, *expected );
+  }
+
+  {
+    lb::url::http::Body body;
+    body.sharedData = expected;
+    const auto[rc, response]{ put( std::move( body ) ) };
+    ASSERT_EQ( rc, lb::url::ResponseCode::eSuccess );
+    EXPECT_EQ( response.code, 200 );
+    EXPECT_EQ( response.content, *expected );
+  }
+
+  {
+    lb::url::http::Body body;
+    body.dataReader = reader( expected );
+    const auto[rc, response]{ put( std::move( body ) ) };
+    ASSERT_EQ( rc, lb::url::ResponseCode::eSuccess );
+    EXPECT_EQ( response.code, 200 );
+    EXPECT_EQ( response.content, *expected );
+  }
+
+  // Unknown size so chunked.
+  {
+    lb::url::http::Body body;
+    body.dataReader = reader( expected );
+    body.dataReader.totalNumBytes = 0;
+    body.chunked = true;
+    const auto[rc, response]{ put( std::move( body ) ) };
+    ASSERT_EQ( rc, lb::url::ResponseCode::eSuccess );
+    EXPECT_EQ( response.code, 200 );
+    EXPECT_EQ( response.content, *expected );
+  }
+
+  // An empty body must not fall back to reading stdin.
+  {
+    const auto[rc, response]{ put( {} ) };
+    ASSERT_EQ( rc, lb::url::ResponseCode::eSuccess );
+    EXPECT_EQ( response.code, 200 );
+    EXPECT_TRUE( response.content.empty() );
+  }
+}
+
+TEST(Http, RequesterPutFile)
+{
+  const int port{ serverList.at( httpd::ServerType::eBasic ).front().port };
+  const std::string url{ "http://" + hostColonPort( port ) + PUTEchoUrl };
+
+  const std::string contents{ largeBody() };
+  char path[]{ "/tmp/lbUrlPutFileXXXXXX" };
+  const int tmpFd{ mkstemp( path ) };
+  ASSERT_GE( tmpFd, 0 );
+  ::close( tmpFd );
+  std::ofstream{ path, std::ios::binary } << contents;
+
+  lb::url::Requester requester;
+
+  auto put = [&]( lb::url::http::Body::File file )
+  {
+    lb::url::http::Request request{ lb::url::http::Request::Method::ePut, url };
+    request.body.file = std::move( file );
+
+    std::promise< std::pair< lb::url::ResponseCode, lb::url::http::Response > > promise;
+    requester.makeRequest( std::move( request )
+                         , [ &promise ]( lb::url::ResponseCode rc, lb::url::http::Response r )
+    {
+      promise.set_value( { rc, std::move( r ) } );
+    } );
+    return promise.get_future().get();
+  };
+
+  // Whole file with pread and memory mapped.
+  for ( const bool memoryMap : { false, true } )
+  {
+    lb::url::http::Body::File file;
+    file.path = path;
+    file.memoryMap = memoryMap;
+    const auto[rc, response]{ put( std::move( file ) ) };
+    ASSERT_EQ( rc, lb::url::ResponseCode::eSuccess );
+    EXPECT_EQ( response.code, 200 );
+    EXPECT_EQ( response.content, contents );
+  }
+
+  // A region that is not page aligned from a descriptor that is closed as
+  // soon as the request is made.
+  for ( const bool memoryMap : { false, true } )
+  {
+    lb::url::http::Body::File file;
+    file.fd = ::open( path, O_RDONLY );
+    ASSERT_GE( file.fd, 0 );
+    file.offset = 5000;
+    file.numBytes = 100000;
+    file.memoryMap = memoryMap;
+
+    lb::url::http::Request request{ lb::url::http::Request::Method::ePut, url };
+    request.body.file = file;
+
+    std::promise< std::pair< lb::url::ResponseCode, lb::url::http::Response > > promise;
+    requester.makeRequest( std::move( request )
+                         , [ &promise ]( lb::url::ResponseCode rc, lb::url::http::Response r )
+    {
+      promise.set_value( { rc, std::move( r ) } );
+    } );
+    ::close( file.fd );
+
+    const auto[rc, response]{ promise.get_future().get() };
+    ASSERT_EQ( rc, lb::url::ResponseCode::eSuccess );
+    EXPECT_EQ( response.code, 200 );
+    EXPECT_EQ( response.content, contents.substr( 5000, 100000 ) );
+  }
+
+  // Rejected without leaking the descriptor opened to check the size.
+  for ( const bool memoryMap : { false, true } )
+  {
+    const size_t numFds{ numOpenFds() };
+    lb::url::http::Body::File file;
+    file.path = path;
+    file.offset = contents.size() + 1;
+    file.memoryMap = memoryMap;
+    EXPECT_THROW( put( std::move( file ) ), std::runtime_error );
+    EXPECT_EQ( numOpenFds(), numFds );
+  }
+
+  std::remove( path );
+
+  {
+    lb::url::http::Body::File file;
+    file.path = path;
+    EXPECT_THROW( put( std::move( file ) ), std::runtime_error );
+  }
+}
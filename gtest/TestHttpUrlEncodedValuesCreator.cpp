@@ -17,8 +17,20 @@
 
 #include <gtest/gtest.h>
 
+#include <lb/url/http/Request.h>
 #include <lb/url/http/UrlEncodedValuesCreator.h>
 
+#include <curl/curl.h>
+
+#include <array>
+#include <map>
+#include <random>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+#include "AllocationCounter.h"
+
 
 TEST(Http, UrlEncodedValuesCrator)
 {
@@ -77,4 +89,108 @@ TEST(Http, UrlEncodedValuesCrator)
     creator.clear();
     EXPECT_TRUE( creator.str().empty() );
   }
+
+  // Test reserve() and moving the string out.
+  {
+    lb::url::http::UrlEncodedValuesCreator creator;
+    creator.reserve( 1000 );
+    EXPECT_TRUE( creator.add( { "fruit" }, { "apple" } ) );
+    EXPECT_EQ( std::move( creator ).str(), std::string{ "fruit=apple" } );
+    EXPECT_TRUE( creator.str().empty() );
+    EXPECT_TRUE( creator.add( { "vegetable" }, { "potato" } ) );
+    EXPECT_EQ( creator.str(), std::string{ "vegetable=potato" } );
+  }
+
+  // Test that reserved space is used without reallocating and that moving the
+  // string out does not copy it, unlike str() on an lvalue.
+  {
+    const lb::url::http::UrlEncodedValuesCreator::Encodable field{ "field" };
+    const lb::url::http::UrlEncodedValuesCreator::Encodable value{ "value & more" };
+
+    // "field=value%20%26%20more" and the '&' separating it from the next.
+    lb::url::http::UrlEncodedValuesCreator creator;
+    creator.reserve( 100 * 25 );
+    size_t numAllocationsBefore{ numAllocationsOnThisThread() };
+    for ( int i = 0; i < 100; ++i )
+    {
+      EXPECT_TRUE( creator.add( field, value ) );
+    }
+    EXPECT_EQ( numAllocationsOnThisThread() - numAllocationsBefore, 0 );
+
+    numAllocationsBefore = numAllocationsOnThisThread();
+    const std::string copied{ creator.str() };
+    EXPECT_EQ( numAllocationsOnThisThread() - numAllocationsBefore, 1 );
+
+    numAllocationsBefore = numAllocationsOnThisThread();
+    const std::string moved{ std::move( creator ).str() };
+    EXPECT_EQ( numAllocationsOnThisThread() - numAllocationsBefore, 0 );
+    EXPECT_EQ( moved, copied );
+    EXPECT_EQ( moved.size(), 100 * 25 - 1 );
+  }
+}
+
+TEST(Http, UrlEncodedValuesCreatorEncoding)
+{
+  // Values of every length around the vectorised block sizes, with reserved
+  // bytes at the start, end and in between, must encode as libcurl would.
+  std::minstd_rand generator{ 42 };
+  std::uniform_int_distribution<int> anyByte{ 0, 255 };
+  std::uniform_int_distribution<int> oneIn{ 0, 7 };
+
+  for ( size_t numBytes = 0; numBytes < 100; ++numBytes )
+  {
+    for ( int trial = 0; trial < 10; ++trial )
+    {
+      std::string value;
+      for ( size_t i = 0; i < numBytes; ++i )
+      {
+        value += oneIn( generator ) == 0 ? char( anyByte( generator ) ) : char( 'a' + i % 26 );
+      }
+
+      lb::url::http::UrlEncodedValuesCreator creator;
+      EXPECT_TRUE( creator.add( { "field", false }, { value } ) );
+
+      char* escaped{ curl_easy_escape( nullptr, value.c_str(), value.size() ) };
+      ASSERT_NE( escaped, nullptr );
+      EXPECT_EQ( creator.str(), "field=" + std::string{ escaped } );
+      curl_free( escaped );
+    }
+  }
+}
+
+TEST(Http, UrlEncodedValuesEncodeForm)
+{
+  // Any range of string-like pairs.
+  const std::map<std::string, std::string> map{ { "fruit", "apple" }, { "vegetable", "pot&to" } };
+  EXPECT_EQ( lb::url::http::encodeForm( map ), "fruit=apple&vegetable=pot%26to" );
+
+  const std::vector< std::pair<std::string_view, const char*> > views{ { "total%", "99.9" }, { "", "skipped" }, { "empty", "" } };
+  EXPECT_EQ( lb::url::http::encodeForm( views ), "total%25=99.9&empty=" );
+
+  const std::array< std::tuple<std::string, std::string>, 2 > tuples{ { { "a b", "c d" }, { "e", "f" } } };
+  EXPECT_EQ( lb::url::http::encodeForm( tuples ), "a%20b=c%20d&e=f" );
+
+  EXPECT_EQ( lb::url::http::encodeForm( std::vector< std::pair<std::string, std::string> >{} ), "" );
+
+  // The same as adding the pairs one at a time.
+  std::vector< std::pair<std::string, std::string> > pairs;
+  lb::url::http::UrlEncodedValuesCreator creator;
+  for ( int i = 0; i < 1000; ++i )
+  {
+    pairs.emplace_back( "field#" + std::to_string( i ), "value &" + std::to_string( i ) );
+    creator.add( { pairs.back().first }, { pairs.back().second } );
+  }
+
+  // In a single allocation, straight into the request.
+  lb::url::http::Request request;
+  size_t numAllocationsBefore{ numAllocationsOnThisThread() };
+  lb::url::http::encodeForm( pairs, request );
+  EXPECT_EQ( numAllocationsOnThisThread() - numAllocationsBefore, 1 );
+  EXPECT_EQ( request.postUrlEncodedValues, creator.str() );
+  EXPECT_EQ( request.postUrlEncodedValues.size(), request.postUrlEncodedValues.capacity() );
+
+  // And none when re-encoding into the same capacity.
+  numAllocationsBefore = numAllocationsOnThisThread();
+  lb::url::http::encodeForm( pairs, request );
+  EXPECT_EQ( numAllocationsOnThisThread() - numAllocationsBefore, 0 );
 }
@@ -0,0 +1,177 @@
+/*
+    Copyright (C) 2023  Paul Fotheringham (LinuxBrickie)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <gtest/gtest.h>
+
+#include <iterator>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <curl/curl.h>
+
+#include <lb/url/http/UrlEncodedValuesCreator.h>
+#include <lb/url/http/UrlEncodedValuesParser.h>
+
+
+using Parser = lb::url::http::UrlEncodedValuesParser;
+using Decoder = lb::url::http::UrlEncodedValuesDecoder;
+using Pairs = std::vector< std::pair<std::string, std::string> >;
+
+
+static Pairs parse( std::string_view data )
+{
+  Pairs pairs;
+  for ( const auto& [ field, value ] : Parser{ data } )
+  {
+    pairs.emplace_back( field, value );
+  }
+  return pairs;
+}
+
+static Pairs parseAndDecode( std::string data )
+{
+  Pairs pairs;
+  for ( const auto& [ field, value ] : Decoder{ data.data(), data.size() } )
+  {
+    pairs.emplace_back( field, value );
+  }
+  return pairs;
+}
+
+// A straightforward decoder to check the vectorised one against.
+static std::string referenceDecode( std::string_view s )
+{
+  auto isHex = []( char c ) { return std::isxdigit( (unsigned char)c ) != 0; };
+
+  std::string decoded;
+  for ( size_t i = 0; i < s.size(); ++i )
+  {
+    if ( s[ i ] == '+' )
+    {
+      decoded += ' ';
+    }
+    else if ( ( s[ i ] == '%' ) && ( i + 2 < s.size() ) && isHex( s[ i + 1 ] ) && isHex( s[ i + 2 ] ) )
+    {
+      decoded += char( std::stoi( std::string{ s.substr( i + 1, 2 ) }, nullptr, 16 ) );
+      i += 2;
+    }
+    else
+    {
+      decoded += s[ i ];
+    }
+  }
+  return decoded;
+}
+
+
+TEST(Http, UrlEncodedValuesParser)
+{
+  EXPECT_TRUE( parse( "" ).empty() );
+  EXPECT_TRUE( parse( "&&" ).empty() );
+  EXPECT_EQ( parse( "fruit=apple&vegetable=pot%26to&total%25=99.9" )
+           , ( Pairs{ { "fruit", "apple" }, { "vegetable", "pot%26to" }, { "total%25", "99.9" } } ) );
+  EXPECT_EQ( parse( "a&b=&&=c&d=e=f" )
+           , ( Pairs{ { "a", "" }, { "b", "" }, { "", "c" }, { "d", "e=f" } } ) );
+
+  EXPECT_EQ( parseAndDecode( "fruit=apple&vegetable=pot%26to&total%25=99.9&say=hello+world" )
+           , ( Pairs{ { "fruit", "apple" }, { "vegetable", "pot&to" }, { "total%", "99.9" }, { "say", "hello world" } } ) );
+
+  EXPECT_EQ( Parser::decode( "%41%62%zz%4+%" ), "Ab%zz%4 %" );
+
+  // The pairs are views of the data.
+  const std::string data{ "field=value" };
+  const auto first{ *Parser{ data }.begin() };
+  EXPECT_EQ( first.field.data(), data.data() );
+  EXPECT_EQ( first.value.data(), data.data() + 6 );
+
+  // Parsing is multi-pass whereas decoding in place is single pass.
+  static_assert( std::is_same_v< std::iterator_traits<Parser::Iterator>::iterator_category
+                               , std::forward_iterator_tag > );
+  static_assert( std::is_same_v< std::iterator_traits<Decoder::Iterator>::iterator_category
+                               , std::input_iterator_tag > );
+}
+
+TEST(Http, UrlEncodedValuesParserFuzz)
+{
+  // Random data biased towards the bytes that matter to the parser and
+  // decoder, at lengths either side of the vectorised block sizes.
+  std::minstd_rand generator{ 2024 };
+  const std::string interesting{ "%%%++&&==0aF9gZ" };
+  std::uniform_int_distribution<int> anyByte{ 0, 255 };
+  std::uniform_int_distribution<size_t> anyInteresting{ 0, interesting.size() - 1 };
+  std::uniform_int_distribution<size_t> anyLength{ 0, 200 };
+
+  auto randomString = [&]( size_t numBytes )
+  {
+    std::string s;
+    for ( size_t i = 0; i < numBytes; ++i )
+    {
+      s += generator() % 2 ? interesting[ anyInteresting( generator ) ] : char( anyByte( generator ) );
+    }
+    return s;
+  };
+
+  for ( int trial = 0; trial < 20000; ++trial )
+  {
+    const std::string data{ randomString( anyLength( generator ) ) };
+
+    // Decoding into a buffer, in place and with libcurl, which does not
+    // decode '+', all agree with the reference.
+    const std::string expected{ referenceDecode( data ) };
+    ASSERT_EQ( Parser::decode( data ), expected ) << trial;
+
+    std::string inPlace{ data };
+    inPlace.resize( Parser::decode( inPlace, inPlace.data() ).size() );
+    ASSERT_EQ( inPlace, expected ) << trial;
+
+    if ( data.find( '+' ) == std::string::npos )
+    {
+      int numBytes{ 0 };
+      char* unescaped{ curl_easy_unescape( nullptr, data.c_str(), data.size(), &numBytes ) };
+      ASSERT_NE( unescaped, nullptr );
+      ASSERT_EQ( std::string( unescaped, numBytes ), expected ) << trial;
+      curl_free( unescaped );
+    }
+
+    // The raw pairs rebuild the data, less empty pairs, and decoding them in
+    // place is the same as decoding them afterwards.
+    const Pairs raw{ parse( data ) };
+    const Pairs decoded{ parseAndDecode( data ) };
+    ASSERT_EQ( raw.size(), decoded.size() );
+    for ( size_t i = 0; i < raw.size(); ++i )
+    {
+      ASSERT_EQ( referenceDecode( raw[ i ].first ), decoded[ i ].first );
+      ASSERT_EQ( referenceDecode( raw[ i ].second ), decoded[ i ].second );
+      ASSERT_EQ( raw[ i ].first.find( '&' ), std::string::npos );
+      ASSERT_EQ( raw[ i ].first.find( '=' ), std::string::npos );
+      ASSERT_EQ( raw[ i ].second.find( '&' ), std::string::npos );
+    }
+
+    // Anything UrlEncodedValuesCreator encodes is parsed back as it was.
+    Pairs pairs;
+    lb::url::http::UrlEncodedValuesCreator creator;
+    for ( int i = 0; i < 3; ++i )
+    {
+      pairs.emplace_back( "f" + randomString( anyLength( generator ) % 20 ), randomString( anyLength( generator ) % 40 ) );
+      creator.add( { pairs.back().first }, { pairs.back().second } );
+    }
+    ASSERT_EQ( parseAndDecode( creator.str() ), pairs ) << trial;
+  }
+}
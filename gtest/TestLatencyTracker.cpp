@@ -0,0 +1,55 @@
+/*
+    Copyright (C) 2023  Paul Fotheringham (LinuxBrickie)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <gtest/gtest.h>
+
+#include "../src/LatencyTracker.h"
+
+
+TEST(Http, LatencyTrackerPercentiles)
+{
+  lb::url::LatencyTracker tracker;
+  for ( int i = 1; i <= 100; ++i )
+  {
+    tracker.add( std::chrono::milliseconds{ i } );
+  }
+
+  // Different percentiles are read off the same sorted window.
+  EXPECT_EQ( tracker.percentile( 50.0 ), std::chrono::milliseconds{ 51 } );
+  EXPECT_EQ( tracker.percentile( 95.0 ), std::chrono::milliseconds{ 96 } );
+  EXPECT_EQ( tracker.percentile( 50.0 ), std::chrono::milliseconds{ 51 } );
+  EXPECT_EQ( tracker.percentile( 100.0 ), std::chrono::milliseconds{ 100 } );
+}
+
+TEST(Http, LatencyTrackerPerHost)
+{
+  lb::url::HostLatencies latencies{ 2 };
+  for ( int i = 0; i < 100; ++i )
+  {
+    latencies.at( "fast" ).add( std::chrono::milliseconds{ 1 } );
+    latencies.at( "slow" ).add( std::chrono::milliseconds{ 500 } );
+  }
+
+  // One slow host does not affect another.
+  EXPECT_EQ( latencies.at( "fast" ).percentile( 95.0 ), std::chrono::milliseconds{ 1 } );
+  EXPECT_EQ( latencies.at( "slow" ).percentile( 95.0 ), std::chrono::milliseconds{ 500 } );
+
+  // A third host drops the least recently used, which starts over.
+  EXPECT_FALSE( latencies.at( "other" ).percentile( 95.0 ) );
+  EXPECT_EQ( latencies.at( "slow" ).percentile( 95.0 ), std::chrono::milliseconds{ 500 } );
+  EXPECT_FALSE( latencies.at( "fast" ).percentile( 95.0 ) );
+}
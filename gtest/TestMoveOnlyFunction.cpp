@@ -0,0 +1,161 @@
+/*
+    Copyright (C) 2023  Paul Fotheringham (LinuxBrickie)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <functional>
+#include <future>
+#include <memory>
+
+#include <lb/url/MoveOnlyFunction.h>
+#include <lb/url/Requester.h>
+
+#include "AllocationCounter.h"
+#include "ServerList.h"
+
+
+using Function = lb::url::MoveOnlyFunction< int( int ) >;
+
+
+TEST(MoveOnlyFunction, Empty)
+{
+  int (*nullFunctionPointer)( int ){ nullptr };
+
+  for ( const auto& f : { Function{}, Function{ nullptr }, Function{ nullFunctionPointer }, Function{ std::function< int( int ) >{} } } )
+  {
+    EXPECT_FALSE( f );
+    EXPECT_THROW( f( 1 ), std::bad_function_call );
+  }
+}
+
+TEST(MoveOnlyFunction, InlineStorage)
+{
+  std::array<int, 10> captured{ 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 };
+  auto lambda = [captured]( int i ) { return captured[ i ]; };
+  static_assert( Function::isStoredInline<decltype( lambda )>() );
+
+  const size_t numAllocationsBefore{ numAllocationsOnThisThread() };
+  Function f{ lambda };
+  Function g{ std::move( f ) };
+  EXPECT_EQ( g( 9 ), 10 );
+  EXPECT_FALSE( f );
+  EXPECT_EQ( numAllocationsOnThisThread(), numAllocationsBefore );
+
+  // Whereas std::function has to allocate for the same capture.
+  std::function< int( int ) > s{ lambda };
+  EXPECT_GT( numAllocationsOnThisThread(), numAllocationsBefore );
+}
+
+TEST(MoveOnlyFunction, HeapStorage)
+{
+  std::array<int, 100> captured{};
+  captured[ 99 ] = 99;
+  auto lambda = [captured]( int i ) { return captured[ i ]; };
+  static_assert( !Function::isStoredInline<decltype( lambda )>() );
+
+  Function f{ lambda };
+  const size_t numAllocationsBefore{ numAllocationsOnThisThread() };
+  Function g;
+  g = std::move( f );
+  EXPECT_EQ( g( 99 ), 99 );
+  EXPECT_EQ( numAllocationsOnThisThread(), numAllocationsBefore );
+}
+
+TEST(MoveOnlyFunction, MoveOnlyCaptures)
+{
+  Function f{ [p = std::make_unique<int>( 42 )]( int i ) { return *p + i; } };
+  EXPECT_EQ( f( 1 ), 43 );
+
+  std::promise<int> promise;
+  auto future{ promise.get_future() };
+  lb::url::MoveOnlyFunction< void( int ) > setter{ [promise = std::move( promise )]( int i ) mutable { promise.set_value( i ); } };
+  setter( 7 );
+  EXPECT_EQ( future.get(), 7 );
+}
+
+TEST(Http, RequesterSubmitAllocations)
+{
+  const int port{ serverList.at( httpd::ServerType::eBasic ).front().port };
+
+  lb::url::Requester requester;
+
+  // The allocations made by makeRequest on this thread.
+  auto submit = [&]( lb::url::http::Response::Callback callback )
+  {
+    lb::url::http::Request request{ lb::url::http::Request::Method::eGet
+                                  , "http://" + hostColonPort( port ) + "/test/url/http/get200" };
+    const size_t numAllocationsBefore{ numAllocationsOnThisThread() };
+    requester.makeRequest( std::move( request ), std::move( callback ) );
+    return numAllocationsOnThisThread() - numAllocationsBefore;
+  };
+
+  std::promise<void> warmUp;
+  submit( [&warmUp]( lb::url::ResponseCode, lb::url::http::Response ) { warmUp.set_value(); } );
+  warmUp.get_future().get();
+
+  // A promise captured by value costs nothing more than a pointer. With
+  // std::function it would have to be shared, and so allocated, as
+  // std::function requires copyable callables.
+  std::promise<lb::url::http::Response> byValue;
+  auto byValueFuture{ byValue.get_future() };
+  std::promise<lb::url::http::Response> byPointer;
+  auto byPointerFuture{ byPointer.get_future() };
+
+  const size_t numByValue
+  {
+    submit( [promise = std::move( byValue )]( lb::url::ResponseCode, lb::url::http::Response r ) mutable
+    {
+      promise.set_value( std::move( r ) );
+    } )
+  };
+  const size_t numByPointer
+  {
+    submit( [&byPointer]( lb::url::ResponseCode, lb::url::http::Response r )
+    {
+      byPointer.set_value( std::move( r ) );
+    } )
+  };
+
+  EXPECT_EQ( numByValue, numByPointer );
+  EXPECT_EQ( byValueFuture.get().code, 200 );
+  EXPECT_EQ( byPointerFuture.get().code, 200 );
+
+  // A capture too large for std::function's small buffer, but within that of
+  // http::Response::Callback, allocates with the former and not the latter.
+  std::promise<lb::url::http::Response> large;
+  auto largeFuture{ large.get_future() };
+  const auto largeCapture = [&large, padding = std::array<void*, 4>{}]( lb::url::ResponseCode, lb::url::http::Response r )
+  {
+    large.set_value( std::move( r ) );
+  };
+  static_assert( sizeof( largeCapture ) > 2 * sizeof( void* ) );
+
+  {
+    const size_t numAllocationsBefore{ numAllocationsOnThisThread() };
+    const std::function< void( lb::url::ResponseCode, lb::url::http::Response ) > baseline{ largeCapture };
+    EXPECT_EQ( numAllocationsOnThisThread() - numAllocationsBefore, 1 );
+  }
+  {
+    const size_t numAllocationsBefore{ numAllocationsOnThisThread() };
+    const lb::url::http::Response::Callback callback{ largeCapture };
+    EXPECT_EQ( numAllocationsOnThisThread() - numAllocationsBefore, 0 );
+  }
+
+  EXPECT_EQ( submit( largeCapture ), numByPointer );
+  EXPECT_EQ( largeFuture.get().code, 200 );
+}
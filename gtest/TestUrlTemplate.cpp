@@ -0,0 +1,72 @@
+/*
+    Copyright (C) 2023  Paul Fotheringham (LinuxBrickie)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <limits>
+
+#include <curl/curl.h>
+
+#include <lb/url/UrlTemplate.h>
+
+
+static constexpr lb::url::UrlTemplate userItems{ "/v1/users/{id}/items?page={n}" };
+
+static_assert( userItems.numPlaceholders() == 2 );
+static_assert( userItems.placeholder( 0 ) == "id" );
+static_assert( userItems.placeholder( 1 ) == "n" );
+
+
+TEST(UrlTemplate, Expand)
+{
+  EXPECT_EQ( userItems.expand( "alice", 2 ), "/v1/users/alice/items?page=2" );
+  EXPECT_EQ( userItems.expand( std::string{ "a/b c" }, -1 ), "/v1/users/a%2Fb%20c/items?page=-1" );
+  EXPECT_EQ( userItems.expand( lb::url::UrlTemplate::Encoded{ "a%2Fb" }, std::numeric_limits<uint64_t>::max() )
+           , "/v1/users/a%2Fb/items?page=18446744073709551615" );
+
+  constexpr lb::url::UrlTemplate noPlaceholders{ "https://example.com/" };
+  EXPECT_EQ( noPlaceholders.expand(), "https://example.com/" );
+
+  constexpr lb::url::UrlTemplate onlyPlaceholders{ "{a}{b}" };
+  EXPECT_EQ( onlyPlaceholders.expand( "x", "" ), "x" );
+
+  EXPECT_THROW( userItems.expand( "alice" ), std::runtime_error );
+  EXPECT_THROW( userItems.expand( "alice", 2, 3 ), std::runtime_error );
+}
+
+TEST(UrlTemplate, Malformed)
+{
+  for ( const char* pattern : { "/users/{id", "/users/id}", "/users/{}", "/users/{{id}}" } )
+  {
+    EXPECT_THROW( lb::url::UrlTemplate{ pattern }, std::runtime_error ) << pattern;
+  }
+}
+
+TEST(UrlTemplate, EscapingMatchesCurl)
+{
+  std::string all;
+  for ( int c = 0; c < 256; ++c )
+  {
+    all += char( c );
+  }
+
+  char* escaped{ curl_easy_escape( nullptr, all.c_str(), all.size() ) };
+  ASSERT_NE( escaped, nullptr );
+  EXPECT_EQ( lb::url::UrlTemplate{ "{all}" }.expand( all ), escaped );
+  curl_free( escaped );
+}
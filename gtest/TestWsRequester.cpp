@@ -88,6 +88,16 @@ const std::unordered_map<std::string, ExpectedResponse> WSExpectedMockResponses
       { { ping, "" } }
     }
   },
+  {
+    "/test/url/ws/large",
+    {
+      lb::url::ResponseCode::eSuccess,
+      // Much larger than a single read, followed by a small message reusing the
+      // same buffer.
+      { { { "Send large" }, std::string( 300000, 'L' ) }
+      , { { "Hello world!" }, { "Hi there!" } } }
+    }
+  },
   {
     "/test/url/ws/goodbye",
     {
@@ -327,6 +337,75 @@ TEST(Ws, Requester_Challenges_Parallel)
   }
 }
 
+TEST(Ws, Requester_Burst)
+{
+  // Far longer than the test should take so that anything left waiting for
+  // the poll to time out shows up as a failure.
+  const size_t pollTimeoutMilliseconds{ 2000 };
+
+  const auto& serverConfigs = serverList.at( httpd::ServerType::eWebSocket );
+  for ( const auto& serverConfig : serverConfigs )
+  {
+    lb::url::Requester requester{ { pollTimeoutMilliseconds } };
+
+    std::vector<std::string> messages;
+    std::promise<void> allReceived;
+    lb::url::ws::Receivers receivers
+    {
+      [&messages, &allReceived]( lb::url::ws::ConnectionID, lb::url::ws::DataOpCode, std::string r )
+      {
+        messages.push_back( std::move( r ) );
+        if ( messages.size() == numBurstMessages )
+        {
+          allReceived.set_value();
+        }
+      },
+      []( lb::url::ws::ConnectionID, lb::url::ws::ControlOpCode, std::string )
+      {
+      }
+    };
+    struct Canary
+    {
+      lb::url::ws::Receivers& receivers;
+      ~Canary() { receivers.stopReceiving(); }
+    } canary{ receivers };
+
+    std::promise<lb::url::ws::Response> connectionEstablishedPromise;
+    requester.makeRequest( {
+                             "ws://" + hostColonPort( serverConfig.port ) + "/test/url/ws/burst",
+                             receivers
+                           }
+                         , [ &connectionEstablishedPromise ]( lb::url::ResponseCode rc, lb::url::ws::Response r )
+                           {
+                             connectionEstablishedPromise.set_value( std::move( r ) );
+                           } );
+    const lb::url::ws::Response response{ connectionEstablishedPromise.get_future().get() };
+
+    // Let the connection go idle so that the Requester is blocked in its poll.
+    std::this_thread::sleep_for( std::chrono::milliseconds( 200 ) );
+
+    // The frames arrive together. They must all be delivered as soon as they
+    // are readable rather than one per poll time-out.
+    const auto start{ std::chrono::steady_clock::now() };
+    EXPECT_EQ( response.senders.sendData( lb::url::ws::DataOpCode::eText, sendBurstMessage ).get()
+             , lb::url::ws::SendResult::eSuccess );
+    auto allReceivedFuture{ allReceived.get_future() };
+    ASSERT_EQ( allReceivedFuture.wait_for( std::chrono::milliseconds( pollTimeoutMilliseconds ) )
+             , std::future_status::ready );
+    EXPECT_LT( std::chrono::steady_clock::now() - start, std::chrono::milliseconds( 1000 ) );
+
+    for ( size_t i = 0; i < numBurstMessages; ++i )
+    {
+      EXPECT_EQ( messages[ i ], "Burst " + std::to_string( i ) );
+    }
+
+    EXPECT_EQ( response.senders.sendClose( lb::encoding::websocket::closestatus::toPayload(
+                                             lb::encoding::websocket::closestatus::ProtocolCode::eNormal )
+                                         , clientCloseReason ).get()
+             , lb::url::ws::SendResult::eSuccess );
+  }
+}
+
 void testRequesterDestruction( int port
                              , size_t pollTimeoutMilliseconds
                              , size_t closeTimeoutInMilliSeconds )
@@ -29,6 +29,10 @@
 const std::string ping{ "PING" };
 const std::string sendControlCloseMessage{ "SEND BACK CONTROL CLOSE" };
 
+//! Answered, on any URL, with \a numBurstMessages data frames sent back-to-back.
+const std::string sendBurstMessage{ "SEND BACK BURST" };
+const size_t numBurstMessages{ 10 };
+
 
 struct ExpectedResponse
 {
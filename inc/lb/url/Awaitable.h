@@ -0,0 +1,250 @@
+#ifndef LIB_LB_URL_AWAITABLE_H
+#define LIB_LB_URL_AWAITABLE_H
+
+/*
+    Copyright (C) 2023  Paul Fotheringham (LinuxBrickie)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/** \file
+    \brief C++20 coroutine support.
+
+    Unlike the rest of the library this header requires C++20. The awaitables
+    here are thin wrappers around the callback API so using them costs no more
+    than a callback: the awaitable lives in the coroutine frame and the
+    callback passed to the library only captures a pointer to it.
+
+    For example
+
+        lb::url::http::Result result{ co_await lb::url::awaitRequest( requester, std::move( request ) ) };
+
+    The coroutine is resumed by an executor, which is any callable taking a
+    std::coroutine_handle<>. It is called on the Requester thread so, as with
+    any callback, should not do any heavy lifting there. The default,
+    InlineExecutor, resumes the coroutine there and then which is only suitable
+    for coroutines that do very little before their next co_await. Otherwise
+    pass an executor that hands the coroutine over to your own thread pool or
+    event loop.
+
+    An operation that completes before it is even started, e.g. a send on a
+    closed WebSocket, does not suspend the coroutine at all. It carries on
+    without the executor being called.
+ */
+
+#if !defined( __cpp_impl_coroutine )
+#error "lb/url/Awaitable.h requires C++20 coroutine support"
+#endif
+
+#include <lb/url/Requester.h>
+
+#include <atomic>
+#include <coroutine>
+#include <optional>
+#include <utility>
+
+
+namespace lb
+{
+
+
+namespace url
+{
+
+
+/** \brief Resumes the coroutine immediately on whichever thread completes the
+           operation, normally the Requester thread.
+ */
+struct InlineExecutor
+{
+  void operator()( std::coroutine_handle<> coroutine ) const
+  {
+    coroutine.resume();
+  }
+};
+
+
+/** \brief Suspends until a callback based operation completes.
+
+    \a Start is invoked with a function to be called exactly once with the
+    result, possibly before \a Start even returns.
+ */
+template<typename T, typename Start, typename Executor>
+class Awaitable
+{
+public:
+  Awaitable( Start s, Executor e )
+    : start{ std::move( s ) }
+    , executor{ std::move( e ) }
+  {
+  }
+
+  bool await_ready() const noexcept { return false; }
+
+  /** \return False, to carry on without suspending, if the operation
+              completed before \a start returned.
+   */
+  bool await_suspend( std::coroutine_handle<> coroutine )
+  {
+    continuation = coroutine;
+
+    // The coroutine may be resumed, and this destroyed, before the start
+    // function returns so it must not be run in place.
+    auto s{ std::move( start ) };
+    s( [this]( T t )
+    {
+      result.emplace( std::move( t ) );
+
+      // Whichever of this and await_suspend finishes second resumes.
+      if ( finished.exchange( true, std::memory_order_acq_rel ) )
+      {
+        executor( continuation );
+      }
+    } );
+
+    // This may be destroyed as soon as the exchange is made.
+    return !finished.exchange( true, std::memory_order_acq_rel );
+  }
+
+  T await_resume()
+  {
+    return std::move( *result );
+  }
+
+private:
+  Start start;
+  Executor executor;
+  std::coroutine_handle<> continuation;
+  std::optional<T> result;
+  std::atomic<bool> finished{ false };
+};
+
+
+namespace http
+{
+
+
+/** \brief The result of awaiting an http::Request. */
+struct Result
+{
+  ResponseCode responseCode;
+  Response response;
+};
+
+
+} // End of namespace http
+
+
+namespace ws
+{
+
+
+/** \brief The result of awaiting a ws::Request. */
+struct Result
+{
+  ResponseCode responseCode;
+  Response response;
+};
+
+
+} // End of namespace ws
+
+
+/** \brief co_await a request, \sa Requester::makeRequest. */
+template<typename Executor = InlineExecutor>
+auto awaitRequest( Requester& requester, http::Request request, Executor executor = {} )
+{
+  auto start = [&requester, request = std::move( request )]( auto resume ) mutable
+  {
+    requester.makeRequest( std::move( request ), [resume]( ResponseCode rc, http::Response r )
+    {
+      resume( { rc, std::move( r ) } );
+    } );
+  };
+  return Awaitable<http::Result, decltype( start ), Executor>{ std::move( start ), std::move( executor ) };
+}
+
+/** \brief co_await the opening of a WebSocket, \sa Requester::makeRequest. */
+template<typename Executor = InlineExecutor>
+auto awaitRequest( Requester& requester, ws::Request request, Executor executor = {} )
+{
+  auto start = [&requester, request = std::move( request )]( auto resume ) mutable
+  {
+    requester.makeRequest( std::move( request ), [resume]( ResponseCode rc, ws::Response r )
+    {
+      resume( { rc, std::move( r ) } );
+    } );
+  };
+  return Awaitable<ws::Result, decltype( start ), Executor>{ std::move( start ), std::move( executor ) };
+}
+
+/** \brief co_await a send, \sa ws::Senders::sendData. */
+template<typename Executor = InlineExecutor>
+auto awaitSendData( const ws::Senders& senders
+                  , ws::DataOpCode opCode
+                  , std::string message
+                  , Executor executor = {}
+                  , size_t maxFrameSize = ws::Senders::UNLIMITED_FRAME_SIZE )
+{
+  auto start = [senders, opCode, message = std::move( message ), maxFrameSize]( auto resume ) mutable
+  {
+    senders.sendData( opCode, std::move( message ), resume, maxFrameSize );
+  };
+  return Awaitable<ws::SendResult, decltype( start ), Executor>{ std::move( start ), std::move( executor ) };
+}
+
+/** \brief co_await a close, \sa ws::Senders::sendClose. */
+template<typename Executor = InlineExecutor>
+auto awaitSendClose( const ws::Senders& senders
+                   , encoding::websocket::closestatus::PayloadCode code
+                   , std::string reason = {}
+                   , Executor executor = {} )
+{
+  auto start = [senders, code, reason = std::move( reason )]( auto resume ) mutable
+  {
+    senders.sendClose( code, std::move( reason ), resume );
+  };
+  return Awaitable<ws::SendResult, decltype( start ), Executor>{ std::move( start ), std::move( executor ) };
+}
+
+/** \brief co_await a ping, \sa ws::Senders::sendPing. */
+template<typename Executor = InlineExecutor>
+auto awaitSendPing( const ws::Senders& senders, std::string payload, Executor executor = {} )
+{
+  auto start = [senders, payload = std::move( payload )]( auto resume ) mutable
+  {
+    senders.sendPing( std::move( payload ), resume );
+  };
+  return Awaitable<ws::SendResult, decltype( start ), Executor>{ std::move( start ), std::move( executor ) };
+}
+
+/** \brief co_await a pong, \sa ws::Senders::sendPong. */
+template<typename Executor = InlineExecutor>
+auto awaitSendPong( const ws::Senders& senders, std::string payload, Executor executor = {} )
+{
+  auto start = [senders, payload = std::move( payload )]( auto resume ) mutable
+  {
+    senders.sendPong( std::move( payload ), resume );
+  };
+  return Awaitable<ws::SendResult, decltype( start ), Executor>{ std::move( start ), std::move( executor ) };
+}
+
+
+} // End of namespace url
+
+
+} // End of namespace lb
+
+
+#endif // LIB_LB_URL_AWAITABLE_H
@@ -0,0 +1,98 @@
+#ifndef LIB_LB_URL_CONNECTIONTUNING_H
+#define LIB_LB_URL_CONNECTIONTUNING_H
+
+/*
+    Copyright (C) 2023  Paul Fotheringham (LinuxBrickie)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <map>
+#include <optional>
+#include <string>
+
+
+namespace lb
+{
+
+
+namespace url
+{
+
+
+/** \brief Socket and connection settings for a transfer.
+
+    Settings that are not set are left at the libcurl defaults. Low latency,
+    request/response style traffic and bulk transfers want rather different
+    settings so a couple of ready made profiles are provided. These are found
+    by name in Requester::Config::tuningProfiles and can be selected for all
+    requests, \sa Requester::Config::tuningProfile, or for a single request,
+    \sa http::Request::tuningProfile.
+ */
+struct ConnectionTuning
+{
+  /** \brief Disable Nagle's algorithm so that small writes are sent at once.
+
+      libcurl enables this by default. Disabling it lets the kernel coalesce
+      small writes which saves packets at the cost of latency.
+   */
+  std::optional<bool> tcpNoDelay;
+
+  /** \brief TCP keepalive probes, e.g. to stop idle pooled connections being
+             dropped by NAT or firewalls.
+   */
+  std::optional<bool> tcpKeepAlive;
+  std::optional<long> tcpKeepIdleSeconds;     //!< Idle time before the first probe.
+  std::optional<long> tcpKeepIntervalSeconds; //!< Time between probes.
+
+  /** \brief The receive buffer size in bytes, 1 KiB to 10 MiB.
+
+      Larger buffers mean fewer, larger, calls to the write callback.
+   */
+  std::optional<long> receiveBufferSize;
+
+  /** \brief The upload buffer size in bytes, 16 KiB to 2 MiB. */
+  std::optional<long> uploadBufferSize;
+
+  /** \brief Send data in the SYN packet of a new connection where supported.
+
+      Saves a round trip when connecting but is only honoured where the
+      kernel and the server both support it.
+   */
+  std::optional<bool> tcpFastOpen;
+
+  /** \brief Idle pooled connections older than this are not reused. */
+  std::optional<long> maxConnectionAgeSeconds;
+
+  /** \brief Overwrite settings with those that are set in \a overrides. */
+  ConnectionTuning& merge( const ConnectionTuning& overrides );
+
+  //! Small requests, e.g. RPC style traffic, where round trip time matters.
+  static ConnectionTuning lowLatency();
+
+  //! Large uploads and downloads where throughput matters.
+  static ConnectionTuning bulk();
+
+  //! The profiles above named "lowLatency" and "bulk".
+  static std::map<std::string, ConnectionTuning> defaultProfiles();
+};
+
+
+} // End of namespace url
+
+
+} // End of namespace lb
+
+
+#endif // LIB_LB_URL_CONNECTIONTUNING_H
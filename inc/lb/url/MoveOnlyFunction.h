@@ -0,0 +1,227 @@
+#ifndef LIB_LB_URL_MOVEONLYFUNCTION_H
+#define LIB_LB_URL_MOVEONLYFUNCTION_H
+
+/*
+    Copyright (C) 2023  Paul Fotheringham (LinuxBrickie)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+
+namespace lb
+{
+
+
+namespace url
+{
+
+
+template<typename Signature, size_t InlineSize = 48>
+class MoveOnlyFunction;
+
+
+/** \brief A move-only alternative to std::function, used for callbacks.
+
+    Unlike std::function the callable need not be copyable so it may capture
+    move-only objects such as a std::promise or a std::unique_ptr. Callables of
+    up to \a InlineSize bytes, enough for several pointers or a std::promise,
+    are stored inline without allocating. Larger ones are moved to the heap.
+
+    As with std::function invoking an empty object throws std::bad_function_call.
+ */
+template<typename R, typename... Args, size_t InlineSize>
+class MoveOnlyFunction<R( Args... ), InlineSize>
+{
+public:
+  MoveOnlyFunction() noexcept = default;
+  MoveOnlyFunction( std::nullptr_t ) noexcept {}
+
+  template< typename F
+          , typename D = std::decay_t<F>
+          , typename = std::enable_if_t< !std::is_same_v<D, MoveOnlyFunction>
+                                      && std::is_invocable_r_v<R, D&, Args...> > >
+  MoveOnlyFunction( F&& f )
+  {
+    if constexpr ( std::is_pointer_v<D> || std::is_member_pointer_v<D> || isStdFunction<D>::value )
+    {
+      if ( !f )
+      {
+        return;
+      }
+    }
+
+    if constexpr ( isStoredInline<D>() )
+    {
+      ::new( static_cast<void*>( storage ) ) D( std::forward<F>( f ) );
+      ops = &inlineOps<D>;
+    }
+    else
+    {
+      *reinterpret_cast<D**>( storage ) = new D( std::forward<F>( f ) );
+      ops = &heapOps<D>;
+    }
+  }
+
+  MoveOnlyFunction( MoveOnlyFunction&& moveFrom ) noexcept
+  {
+    moveFrom.moveTo( *this );
+  }
+
+  MoveOnlyFunction& operator=( MoveOnlyFunction&& moveFrom ) noexcept
+  {
+    if ( this != &moveFrom )
+    {
+      reset();
+      moveFrom.moveTo( *this );
+    }
+    return *this;
+  }
+
+  MoveOnlyFunction& operator=( std::nullptr_t ) noexcept
+  {
+    reset();
+    return *this;
+  }
+
+  MoveOnlyFunction( const MoveOnlyFunction& ) = delete;
+  MoveOnlyFunction& operator=( const MoveOnlyFunction& ) = delete;
+
+  ~MoveOnlyFunction()
+  {
+    reset();
+  }
+
+  explicit operator bool() const noexcept
+  {
+    return ops != nullptr;
+  }
+
+  R operator()( Args... args ) const
+  {
+    if ( !ops )
+    {
+      throw std::bad_function_call{};
+    }
+    return ops->invoke( storage, std::forward<Args>( args )... );
+  }
+
+  /** \brief Whether a callable of type \a F is stored without allocating. */
+  template<typename F>
+  static constexpr bool isStoredInline()
+  {
+    return ( sizeof( F ) <= InlineSize )
+        && ( alignof( F ) <= alignof( std::max_align_t ) )
+        && std::is_nothrow_move_constructible_v<F>;
+  }
+
+private:
+  template<typename F>
+  struct isStdFunction : std::false_type {};
+  template<typename S>
+  struct isStdFunction< std::function<S> > : std::true_type {};
+
+  struct Ops
+  {
+    R    (*invoke)( void* storage, Args&&... args );
+    void (*move)( void* from, void* to ) noexcept; //!< Leaves \a from destroyed.
+    void (*destroy)( void* storage ) noexcept;
+  };
+
+  template<typename F>
+  static R invokeCallable( F& f, Args&&... args )
+  {
+    if constexpr ( std::is_void_v<R> )
+    {
+      std::invoke( f, std::forward<Args>( args )... );
+    }
+    else
+    {
+      return std::invoke( f, std::forward<Args>( args )... );
+    }
+  }
+
+  template<typename F>
+  static constexpr Ops inlineOps
+  {
+    []( void* s, Args&&... args ) -> R
+    {
+      return invokeCallable( *static_cast<F*>( s ), std::forward<Args>( args )... );
+    },
+    []( void* from, void* to ) noexcept
+    {
+      ::new( to ) F( std::move( *static_cast<F*>( from ) ) );
+      static_cast<F*>( from )->~F();
+    },
+    []( void* s ) noexcept
+    {
+      static_cast<F*>( s )->~F();
+    }
+  };
+
+  template<typename F>
+  static constexpr Ops heapOps
+  {
+    []( void* s, Args&&... args ) -> R
+    {
+      return invokeCallable( **static_cast<F**>( s ), std::forward<Args>( args )... );
+    },
+    []( void* from, void* to ) noexcept
+    {
+      *static_cast<F**>( to ) = *static_cast<F**>( from );
+    },
+    []( void* s ) noexcept
+    {
+      delete *static_cast<F**>( s );
+    }
+  };
+
+  void moveTo( MoveOnlyFunction& to ) noexcept
+  {
+    if ( ops )
+    {
+      ops->move( storage, to.storage );
+      to.ops = ops;
+      ops = nullptr;
+    }
+  }
+
+  void reset() noexcept
+  {
+    if ( ops )
+    {
+      ops->destroy( storage );
+      ops = nullptr;
+    }
+  }
+
+  // Mutable so that, like std::function, a const object can invoke a callable
+  // whose operator() is not const.
+  alignas( std::max_align_t ) mutable unsigned char storage[ InlineSize ];
+  const Ops* ops{ nullptr };
+};
+
+
+} // End of namespace url
+
+
+} // End of namespace lb
+
+
+#endif // LIB_LB_URL_MOVEONLYFUNCTION_H
@@ -0,0 +1,52 @@
+#ifndef LIB_LB_URL_PRIORITY_H
+#define LIB_LB_URL_PRIORITY_H
+
+/*
+    Copyright (C) 2023  Paul Fotheringham (LinuxBrickie)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+namespace lb
+{
+
+
+namespace url
+{
+
+
+/** \brief The priority of a request.
+
+    When Requester has more requests than it is allowed to have in flight
+    (\sa Requester::Config::maxConcurrentRequests) queued requests are admitted
+    in priority order, oldest first within a priority. Where HTTP/2 is in use
+    the priority is also mapped to a stream weight.
+ */
+enum class Priority
+{
+  eLow,
+  eNormal,
+  eHigh,
+  eCritical
+};
+
+
+} // End of namespace url
+
+
+} // End of namespace lb
+
+
+#endif // LIB_LB_URL_PRIORITY_H
@@ -0,0 +1,79 @@
+#ifndef LIB_LB_URL_REQUESTHANDLE_H
+#define LIB_LB_URL_REQUESTHANDLE_H
+
+/*
+    Copyright (C) 2023  Paul Fotheringham (LinuxBrickie)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <memory>
+
+
+namespace lb
+{
+
+
+namespace url
+{
+
+
+/** \brief Identifies a request made via \a Requester so that it can be controlled.
+
+    This is a lightweight object that may be freely copied and outlive both the
+    request and the \a Requester. Once either is gone its methods do nothing.
+ */
+class RequestHandle
+{
+public:
+  /** \brief Create an invalid object. \a cancel will do nothing. */
+  RequestHandle() = default;
+  RequestHandle( RequestHandle&& ) = default;
+  RequestHandle& operator=( RequestHandle&& ) = default;
+  RequestHandle( const RequestHandle& ) = default;
+  RequestHandle& operator=( const RequestHandle& ) = default;
+
+  /** \brief Stop the request if it has not already completed.
+
+      May be called from any thread, including from within a response callback.
+      The call will not block. The request is removed on the \a Requester's
+      thread, whether it is in flight, queued or waiting to be retried, and its
+      response callback is invoked with ResponseCode::eAborted. The callback is
+      still only ever invoked once so if the request completes first then the
+      cancellation is ignored.
+   */
+  void cancel() const;
+
+  /** \brief Resume receiving after http::Request::BodySink returned ePause,
+             or sending after a mime::MimePart::DataReader returned rcReadPause.
+
+      May be called from any thread. The transfer is unpaused on the
+      \a Requester's thread. Does nothing if the transfer is not paused.
+   */
+  void resume() const;
+
+  struct Impl; //!< Opaque implementation detail.
+
+private:
+  std::shared_ptr<Impl> d;
+};
+
+
+} // End of namespace url
+
+
+} // End of namespace lb
+
+
+#endif // LIB_LB_URL_REQUESTHANDLE_H
@@ -18,15 +18,27 @@
     along with this program.  If not, see <https://www.gnu.org/licenses/>.
 */
 
+#include <lb/url/ConnectionTuning.h>
+#include <lb/url/RequestHandle.h>
+
 #include <lb/url/http/Request.h>
 #include <lb/url/http/Response.h>
 
 #include <lb/url/ws/Request.h>
 #include <lb/url/ws/Response.h>
 
+#include <chrono>
+#include <cstdint>
 #include <functional>
+#include <future>
+#include <map>
 #include <memory>
 #include <string>
+#include <vector>
+
+#if ( __cplusplus >= 202002L ) && __has_include( <span> )
+#include <span>
+#endif
 
 
 namespace lb
@@ -49,10 +61,145 @@ public:
     struct Config
     {
       size_t pollTimeoutMilliseconds{ 50 };
+
+      /** \brief The maximum number of requests in flight, zero for no limit.
+
+          Requests over the limit wait in a queue and are admitted in order of
+          their Priority. Retries and hedges of requests that have already been
+          admitted are not held back.
+       */
+      size_t maxConcurrentRequests{ 0 };
+
+      /** \brief Starvation protection for low priority requests.
+
+          A queued request that has waited at least this long is admitted ahead
+          of any higher priority requests.
+       */
+      size_t starvationTimeoutMilliseconds{ 1000 };
+
+      /** \brief Limits applied to each host, or rate limit key.
+
+          Requests that would exceed a limit wait in the admission queue, without
+          blocking the submitting thread, until they can be admitted. The time
+          spent waiting is reported in http::Response::queueWaitMicroseconds.
+
+          Retries keep their place within \a maxConcurrentRequests but each
+          needs a token so may be delayed beyond their backoff. Hedges count
+          as requests in their own right and are not issued if the host is at
+          either limit.
+       */
+      struct HostLimits
+      {
+        size_t maxConcurrentRequests{ 0 }; //!< Zero for no limit.
+        double requestsPerSecond{ 0.0 };   //!< Token bucket refill rate, zero for no limit.
+        size_t burst{ 1 };                 //!< Token bucket capacity.
+      };
+
+      //! Applied to any host, or key, not in \a hostLimits.
+      HostLimits defaultHostLimits;
+
+      /** \brief Limits for specific hosts, or keys, \sa http::Request::rateLimitKey. */
+      std::map<std::string, HostLimits> hostLimits;
+
+      /** \brief Limits retries across all requests to avoid retry storms.
+
+          Each new request earns \a ratio of a retry and each retry spends one.
+          In addition up to \a minRetriesPerSecond retries per second are
+          allowed regardless so that retries still work at low request rates.
+          \sa http::Request::RetryPolicy
+       */
+      struct RetryBudget
+      {
+        double ratio{ 0.2 };
+        size_t minRetriesPerSecond{ 10 };
+      } retryBudget;
+
+      /** \brief Caps hedged requests, \sa http::Request::HedgePolicy.
+
+          At most \a maxFraction of hedgeable requests will be duplicated.
+       */
+      struct Hedging
+      {
+        double maxFraction{ 0.1 };
+      } hedging;
+
+      /** \brief Limits memory used by response bodies held awaiting completion.
+
+          Once the bytes held across all requests exceed \a highBytes the
+          largest transfers are paused, one at a time, whilst the others carry
+          on. Paused transfers are resumed once the total drops to \a lowBytes,
+          which happens as requests complete. One transfer is always left
+          running so that progress is made. A \a highBytes of zero, the default,
+          disables this.
+
+          Bodies passed to an http::Request::BodySink are not held so do not
+          count.
+       */
+      struct ReceiveWatermarks
+      {
+        size_t highBytes{ 0 };
+        size_t lowBytes{ 0 };
+      } receiveWatermarks;
+
+      /** \brief Named connection tuning profiles.
+
+          Includes "lowLatency" and "bulk" by default, \sa ConnectionTuning.
+          Add to or replace these as required.
+       */
+      std::map<std::string, ConnectionTuning> tuningProfiles{ ConnectionTuning::defaultProfiles() };
+
+      /** \brief The profile in \a tuningProfiles applied to all requests.
+
+          Empty, the default, for the libcurl defaults. A request may select a
+          different profile, and override individual settings, \sa
+          http::Request::tuningProfile.
+       */
+      std::string tuningProfile;
+
+      /** \brief The number of completions that can wait to be collected by
+                 pollCompletions, rounded up to a power of two.
+
+          If more are waiting then the rest are held back, without blocking the
+          Requester thread, until there is room.
+       */
+      size_t completionQueueCapacity{ 1024 };
     };
 
     static Config defaultConfig() { return Config{}; } // gcc bug workaround
 
+    /** \brief Running totals for hedged requests. */
+    struct HedgeStatistics
+    {
+      size_t numHedged{ 0 };    //!< Duplicate requests issued.
+      size_t numHedgeWins{ 0 }; //!< Times the duplicate responded first.
+      size_t numDenied{ 0 };    //!< Duplicates not issued because of Config::hedging or Config::hostLimits, or that failed to be created.
+    };
+
+    /** \brief A request made with a tag rather than a callback, \sa pollCompletions. */
+    struct Completion
+    {
+      uint64_t tag{ 0 };
+      ResponseCode responseCode{ ResponseCode::eFailure };
+      http::Response response;
+    };
+
+    /** \brief The outcome of prewarm for each host, in the order given. */
+    struct PrewarmResult
+    {
+      struct Host
+      {
+        std::string host;
+
+        //! The number of connections opened and left in the connection pool.
+        size_t numConnections{ 0 };
+
+        //! The addresses the host name now resolves to, empty if none were pinned.
+        std::vector<std::string> pinnedAddresses;
+      };
+
+      std::vector<Host> hosts;
+    };
+
     Requester( Config = defaultConfig() );
     ~Requester();
 
@@ -60,8 +207,41 @@ public:
 
         The call will not block. Instead the request will be serviced in
         a thread and the response function will be invoked upon completion.
+
+        The returned handle may be used to cancel the request.
+
+        Throws std::runtime_error if the request names a tuning profile that
+        is not in Config::tuningProfiles.
+     */
+    RequestHandle makeRequest( http::Request, http::Response::Callback );
+
+    /** \brief Submit request without a callback.
+
+        Instead, once complete, a Completion with \a tag is queued for
+        collection by pollCompletions. This suits batch workers that would
+        rather not have their code called on the Requester thread.
      */
-    void makeRequest( http::Request, http::Response::Callback );
+    RequestHandle makeRequest( http::Request, uint64_t tag );
+
+    /** \brief Collect completed requests made with a tag.
+        \return The number of completions written to \a completions.
+
+        Takes up to \a maxNumCompletions at once. If none are ready then waits
+        up to \a timeout for at least one, zero for no waiting. Completions
+        finished together are made available together so draining in batches
+        costs one wakeup for many completions.
+
+        May be called from any number of threads but the Requester must not be
+        destroyed whilst any are waiting.
+     */
+    size_t pollCompletions( Completion* completions, size_t maxNumCompletions, std::chrono::milliseconds timeout );
+
+#ifdef __cpp_lib_span
+    size_t pollCompletions( std::span<Completion> completions, std::chrono::milliseconds timeout )
+    {
+      return pollCompletions( completions.data(), completions.size(), timeout );
+    }
+#endif
 
     /** \brief Submit request to open a WebSocket.
 
@@ -74,6 +254,32 @@ public:
      */
     void makeRequest( ws::Request, ws::Response::Callback );
 
+    /** \brief Take DNS resolution and connection set up off the critical path
+               of the first requests to \a hosts.
+
+        Each host may be a name, a name and port, or a URL such as
+        "https://example.com:8443". \a connectionsPerHost connections are
+        opened to each, in the background, and left idle in the connection pool
+        for requests to reuse. The addresses connected to are then pinned, as
+        if by CURLOPT_RESOLVE, for the lifetime of the Requester so that later
+        requests never wait for DNS.
+
+        Idle connections are only kept for ConnectionTuning::maxConnectionAgeSeconds
+        so pre-warm shortly before the traffic is expected, e.g. in a readiness
+        probe that waits on the returned future. The future is ready once every
+        connection has been opened or has failed. If the Requester is destroyed
+        first then the outstanding connections are abandoned and the future is
+        still made ready. Hosts not finished by then count only the connections
+        already opened and have no addresses pinned.
+
+        The connections use Config::tuningProfile and are not subject to
+        Config::hostLimits.
+     */
+    std::future<PrewarmResult> prewarm( std::vector<std::string> hosts, size_t connectionsPerHost = 1 );
+
+    /** \brief Statistics for hedged requests, \sa http::Request::HedgePolicy. */
+    HedgeStatistics getHedgeStatistics() const;
+
     /** \brief Check that the global initialisation of the curl library is successful.
 
        Global initialisation happens before main(). If false then the library is unusable.
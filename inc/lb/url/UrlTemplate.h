@@ -0,0 +1,185 @@
+#ifndef LIB_LB_URL_URLTEMPLATE_H
+#define LIB_LB_URL_URLTEMPLATE_H
+
+/*
+    Copyright (C) 2023  Paul Fotheringham (LinuxBrickie)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <array>
+#include <charconv>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+
+namespace lb
+{
+
+
+namespace url
+{
+
+
+/** \brief A URL, or part of one, with placeholders for values, e.g.
+
+    \code
+    static constexpr lb::url::UrlTemplate userItems{ "/v1/users/{id}/items?page={n}" };
+    std::string url{ userItems.expand( userName, 2 ) };
+    \endcode
+
+    Placeholders are a name in braces and are replaced, in order, by the
+    arguments to expand. The pattern is parsed by the constexpr constructor so
+    a constexpr template is parsed at compile time, and a malformed pattern
+    does not compile.
+
+    How an argument is substituted depends upon its type:
+    - strings are URL encoded with the same rules as UrlEncodedValuesCreator,
+      i.e. everything other than letters, digits and -._~ is percent-encoded;
+    - integers are formatted in decimal and need no encoding;
+    - Encoded strings are copied as-is as they are already encoded.
+
+    expand computes the exact size of the URL up front so that it is built in
+    a single allocation.
+ */
+class UrlTemplate
+{
+public:
+  static constexpr size_t maxNumPlaceholders{ 16 };
+
+  /** \brief A string that is already URL encoded, or needs no encoding. */
+  struct Encoded
+  {
+    std::string_view s;
+  };
+
+  /** \brief An argument for a placeholder, converted from its typed value.
+
+      Only ever created by expand, in place.
+   */
+  struct Argument
+  {
+    Argument( std::string_view s ) : text{ s } {}
+    Argument( const std::string& s ) : text{ s } {}
+    Argument( const char* s ) : text{ s } {}
+    Argument( Encoded e ) : text{ e.s }, needsEncoded{ false } {}
+
+    template< typename T
+            , std::enable_if_t< std::is_integral_v<T>
+                             && !std::is_same_v<T, bool>
+                             && !std::is_same_v<T, char>, int > = 0 >
+    Argument( T value )
+      : needsEncoded{ false }
+    {
+      const auto result{ std::to_chars( digits, digits + sizeof digits, value ) };
+      text = { digits, size_t( result.ptr - digits ) };
+    }
+
+    // Refers to its own digits so must not be copied.
+    Argument( const Argument& ) = delete;
+    Argument& operator=( const Argument& ) = delete;
+
+    std::string_view text;
+    bool needsEncoded{ true };
+    char digits[ 24 ];
+  };
+
+  /** \brief Parse \a pattern. Throws std::runtime_error if it is malformed.
+
+      A pattern is malformed if it has unbalanced braces, an empty placeholder
+      name or more than \a maxNumPlaceholders placeholders. The pattern is not
+      copied so must outlive the template, as a string literal does.
+   */
+  constexpr explicit UrlTemplate( std::string_view pattern )
+  {
+    size_t literalStart{ 0 };
+    for ( size_t i = 0; i < pattern.size(); ++i )
+    {
+      if ( pattern[ i ] == '}' )
+      {
+        throw std::runtime_error( "Unmatched } in URL template" );
+      }
+      if ( pattern[ i ] != '{' )
+      {
+        continue;
+      }
+
+      const size_t close{ pattern.find( '}', i ) };
+      if ( close == std::string_view::npos )
+      {
+        throw std::runtime_error( "Unmatched { in URL template" );
+      }
+      const std::string_view name{ pattern.substr( i + 1, close - i - 1 ) };
+      if ( name.empty() || ( name.find( '{' ) != std::string_view::npos ) )
+      {
+        throw std::runtime_error( "Invalid placeholder in URL template" );
+      }
+      if ( numNames == maxNumPlaceholders )
+      {
+        throw std::runtime_error( "Too many placeholders in URL template" );
+      }
+
+      literals[ numNames ] = pattern.substr( literalStart, i - literalStart );
+      literalsNumBytes += literals[ numNames ].size();
+      names[ numNames++ ] = name;
+
+      i = close;
+      literalStart = close + 1;
+    }
+    literals[ numNames ] = pattern.substr( literalStart );
+    literalsNumBytes += literals[ numNames ].size();
+  }
+
+  constexpr size_t numPlaceholders() const { return numNames; }
+
+  constexpr std::string_view placeholder( size_t i ) const { return names[ i ]; }
+
+  /** \brief Substitute \a args for the placeholders.
+
+      Throws std::runtime_error if the number of arguments does not match the
+      number of placeholders.
+   */
+  template<typename... Args>
+  std::string expand( const Args&... args ) const
+  {
+    if constexpr ( sizeof...( Args ) == 0 )
+    {
+      return substitute( nullptr, 0 );
+    }
+    else
+    {
+      const Argument arguments[]{ Argument( args )... };
+      return substitute( arguments, sizeof...( Args ) );
+    }
+  }
+
+private:
+  std::array<std::string_view, maxNumPlaceholders + 1> literals{}; //!< Either side of each placeholder.
+  std::array<std::string_view, maxNumPlaceholders> names{};
+  size_t numNames{ 0 };
+  size_t literalsNumBytes{ 0 };
+
+  std::string substitute( const Argument* arguments, size_t numArguments ) const;
+};
+
+
+} // End of namespace url
+
+
+} // End of namespace lb
+
+
+#endif // LIB_LB_URL_URLTEMPLATE_H
@@ -0,0 +1,114 @@
+#ifndef LIB_LB_URL_HTTP_BODY_H
+#define LIB_LB_URL_HTTP_BODY_H
+
+/*
+    Copyright (C) 2023  Paul Fotheringham (LinuxBrickie)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "BodyStream.h"
+#include "../mime/MimePart.h"
+
+#include <memory>
+#include <string>
+
+
+namespace lb
+{
+
+
+namespace url
+{
+
+
+namespace http
+{
+
+
+/** \brief The body of a PUT or POST request.
+
+    The body is passed to libcurl from a read callback so, other than into
+    libcurl's own send buffer, it is never copied.
+
+    Use one of \a data, \a sharedData, \a file, \a dataReader or \a stream. If
+    more than one is set then \a stream takes precedence, then \a dataReader,
+    then \a file, then \a sharedData.
+ */
+struct Body
+{
+  /** \brief The data to be sent, owned by the request.
+
+      Move the data in to avoid a copy.
+   */
+  std::string data;
+
+  /** \brief Read-only data that can be shared, e.g. between many requests
+             uploading the same payload.
+   */
+  std::shared_ptr<const std::string> sharedData;
+
+  /** \brief The data to be sent is read on demand.
+
+      Works exactly as for a MIME part except that if the size of the data is
+      not known up front then set \a chunked and \a totalNumBytes is ignored.
+      The read function signals the end of the data by returning zero.
+
+      If \a dataSeekFn is not set and libcurl needs to rewind the data, e.g.
+      to retry or follow a redirect, then the transfer fails.
+   */
+  mime::MimePart::DataReader dataReader;
+
+  /** \brief Upload a region of a file without reading it into memory first.
+
+      Works exactly as for a MIME part, \sa mime::MimePart::File.
+   */
+  using File = mime::MimePart::File;
+  File file;
+
+  /** \brief The data to be sent is written incrementally by a producer.
+
+      Always sent with chunked transfer encoding. As the data is only sent
+      once, the request cannot be retried.
+   */
+  BodyStream stream;
+
+  /** \brief Send using chunked transfer encoding rather than with a
+             Content-Length.
+
+      Required if the size of the data is not known up front.
+   */
+  bool chunked{ false };
+
+  bool empty() const;
+
+  /** \brief The number of bytes to be sent, if known.
+
+      For a \a file this is File::numBytes so may be zero until the file is
+      opened. Always zero for a \a stream.
+   */
+  size_t size() const;
+};
+
+
+} // End of namespace http
+
+
+} // End of namespace url
+
+
+} // End of namespace lb
+
+
+#endif // LIB_LB_URL_HTTP_BODY_H
@@ -0,0 +1,99 @@
+#ifndef LIB_LB_URL_HTTP_BODYSTREAM_H
+#define LIB_LB_URL_HTTP_BODYSTREAM_H
+
+/*
+    Copyright (C) 2023  Paul Fotheringham (LinuxBrickie)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <memory>
+#include <string>
+
+
+namespace lb
+{
+
+
+namespace url
+{
+
+
+namespace http
+{
+
+
+/** \brief A request body that is produced incrementally, e.g. streamed logs.
+
+    The producer writes data from any thread whilst the request is in flight
+    and the data is sent as it arrives using chunked transfer encoding, so the
+    size of the body need not be known up front. Whenever the data written so
+    far has all been sent the transfer is paused, and it is resumed by the next
+    write, so generation and transmission are pipelined without any thread
+    blocking.
+
+    Copies refer to the same stream. Keep a copy to write to after passing
+    another in Body::stream.
+ */
+class BodyStream
+{
+public:
+  /** \brief Create an invalid object. No body is streamed and writes fail. */
+  BodyStream() = default;
+  BodyStream( BodyStream&& ) = default;
+  BodyStream& operator=( BodyStream&& ) = default;
+  BodyStream( const BodyStream& ) = default;
+  BodyStream& operator=( const BodyStream& ) = default;
+
+  /** \brief Create a valid, empty stream. */
+  static BodyStream create();
+
+  explicit operator bool() const;
+
+  /** \brief Append \a data to the body.
+      \return False if the stream is invalid, finished or aborted.
+
+      Writing an empty string does nothing.
+   */
+  bool write( std::string data ) const;
+
+  /** \brief Signal the end of the body once everything written has been sent. */
+  void finish() const;
+
+  /** \brief Fail the transfer, e.g. if the producer hits an error. */
+  void abort() const;
+
+  /** \brief The number of bytes written but not yet sent.
+
+      Producers can use this to stop getting too far ahead of the transfer.
+   */
+  size_t numBufferedBytes() const;
+
+  struct Impl; //!< Opaque implementation detail.
+
+private:
+  std::shared_ptr<Impl> d;
+};
+
+
+} // End of namespace http
+
+
+} // End of namespace url
+
+
+} // End of namespace lb
+
+
+#endif // LIB_LB_URL_HTTP_BODYSTREAM_H
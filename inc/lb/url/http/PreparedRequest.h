@@ -0,0 +1,107 @@
+#ifndef LIB_LB_URL_HTTP_PREPAREDREQUEST_H
+#define LIB_LB_URL_HTTP_PREPAREDREQUEST_H
+
+/*
+    Copyright (C) 2023  Paul Fotheringham (LinuxBrickie)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <memory>
+#include <string_view>
+
+
+namespace lb
+{
+
+
+namespace url
+{
+
+
+namespace http
+{
+
+
+struct Request;
+
+
+/** \brief A template for requests that share a method, base URL and headers.
+
+    Normally the URL of every request is parsed, and a list of its headers is
+    built, when it is made. A PreparedRequest does this once for the base URL
+    and headers of \a prototype and the requests created from it reuse them.
+    Only the path and query are substituted per request. The body, if any, is
+    set on the created Request as normal.
+
+    A PreparedRequest is immutable once constructed so it can be shared by, and
+    create requests on, any number of threads. Copies refer to the same
+    template, which is kept alive by the requests created from it.
+
+    Request is declared in Request.h, which includes this header.
+ */
+class PreparedRequest
+{
+public:
+  /** \brief Create an invalid object, i.e. one that prepares nothing. */
+  PreparedRequest() = default;
+  PreparedRequest( PreparedRequest&& ) = default;
+  PreparedRequest& operator=( PreparedRequest&& ) = default;
+  PreparedRequest( const PreparedRequest& ) = default;
+  PreparedRequest& operator=( const PreparedRequest& ) = default;
+
+  /** \brief Prepare requests like \a prototype.
+
+      The URL of \a prototype is the base URL. Everything else apart from the
+      body, e.g. the method, headers, retry policy and priority, is copied into
+      each created request.
+
+      Throws std::runtime_error if the base URL cannot be parsed.
+   */
+  explicit PreparedRequest( const Request& prototype );
+
+  explicit operator bool() const;
+
+  /** \brief Create a request for \a path and \a query relative to the base URL.
+
+      \a path is appended to the path of the base URL, with a '/' separator if
+      needed, e.g. a base URL of https://example.com/v2 and a path of users/42
+      gives https://example.com/v2/users/42. \a query is appended to any query
+      of the base URL. Both are sent as-is and so must already be URL encoded.
+
+      The URL of the created request is left empty, the path and query are
+      held in Request::prepared instead, so that no URL string is built or
+      parsed. Setting the URL stops the prepared base URL being used. Its
+      headers are empty; any that are added are sent along with the prepared
+      headers.
+   */
+  Request create( std::string_view path = {}, std::string_view query = {} ) const;
+
+  struct Impl; //!< Opaque implementation detail.
+
+private:
+  std::shared_ptr<const Impl> d;
+};
+
+
+} // End of namespace http
+
+
+} // End of namespace url
+
+
+} // End of namespace lb
+
+
+#endif // LIB_LB_URL_HTTP_PREPAREDREQUEST_H
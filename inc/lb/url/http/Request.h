@@ -18,10 +18,16 @@
     along with this program.  If not, see <https://www.gnu.org/licenses/>.
 */
 
+#include "Body.h"
+#include "PreparedRequest.h"
+#include "UrlEncodedValuesCreator.h"
 #include "../mime/MimePart.h"
+#include "../ConnectionTuning.h"
+#include "../Priority.h"
 
 #include <functional>
 #include <string>
+#include <string_view>
 #include <vector>
 
 
@@ -37,16 +43,14 @@ namespace http
 {
 
 
+/** \brief A request for a URL.
+
+    An aggregate so that it can be brace initialised, e.g. with just the method
+    and URL. No constructors are declared, not even defaulted ones, as in C++20
+    that would stop it being an aggregate.
+ */
 struct Request
 {
-  Request() = default;
-
-  // Default move/copy construction and assignment.
-  Request( Request&& ) = default;
-  Request& operator=( Request&& ) = default;
-  Request( const Request& ) = default;
-  Request& operator=( const Request& ) = default;
-
   enum class Method
   {
     eInvalid,
@@ -84,9 +88,181 @@ struct Request
   std::string postUrlEncodedValues;
 
   mime::Mime mimePost;
+
+  /** \brief Declarative policy for retrying failed requests.
+
+      By default a request is attempted exactly once. If \a maxAttempts is
+      greater than one then an attempt that fails with one of the retryable
+      HTTP status codes or libcurl errors is retried after an exponential
+      backoff delay. The delay is scheduled on the Requester thread so no
+      thread is blocked whilst waiting. Retries also have to be paid for from
+      the Requester's retry budget, \sa Requester::Config::retryBudget, and if
+      the budget is exhausted the failed attempt is responded to as-is.
+
+      The number of attempts actually made is reported in
+      Response::numAttempts.
+   */
+  struct RetryPolicy
+  {
+    /** \brief Total number of attempts including the first one. */
+    unsigned int maxAttempts{ 1 };
+
+    /** \brief HTTP status codes that indicate a transient failure. */
+    std::vector<unsigned int> retryableStatusCodes{ 408, 429, 500, 502, 503, 504 };
+
+    /** \brief libcurl error codes (CURLcode values) that indicate a transient
+               failure.
+
+        Defaults to failures to resolve, connect, send or receive and time-outs.
+     */
+    std::vector<int> retryableCurlCodes{ defaultRetryableCurlCodes() };
+
+    size_t initialBackoffMilliseconds{ 100 };
+    double backoffMultiplier{ 2.0 };
+    size_t maxBackoffMilliseconds{ 10000 };
+
+    /** \brief The fraction of each backoff delay that is randomised.
+
+        Ranges from 0.0 for no jitter up to 1.0 for "full" jitter where the
+        delay is anywhere between zero and the backoff. Jitter stops clients
+        that failed together from retrying together.
+     */
+    double jitter{ 1.0 };
+
+    static std::vector<int> defaultRetryableCurlCodes();
+  } retryPolicy;
+
+  /** \brief Policy for hedging slow requests to cut tail latency.
+
+      If the request has not completed after the hedge delay then Requester
+      issues a duplicate request. The first successful response (i.e. one that
+      is not a transfer failure or a 5xx status code) is passed to the callback
+      and the other transfer is cancelled. Your callback is still only ever
+      invoked once.
+
+      The delay is the tracked \a delayPercentile of recent request latencies
+      to the same host, or \a rateLimitKey, if set, otherwise
+      \a delayMilliseconds. Until enough latencies have been
+      tracked \a delayMilliseconds is used. If both are zero, the default,
+      there is no hedging.
+
+      Only GET and HEAD requests are ever hedged as they are idempotent.
+      Hedged traffic is also capped, \sa Requester::Config::hedging.
+   */
+  struct HedgePolicy
+  {
+    size_t delayMilliseconds{ 0 };
+    double delayPercentile{ 0.0 }; //!< e.g. 95.0 to hedge after the p95 latency.
+  } hedgePolicy;
+
+  /** \brief Orders admission of queued requests, \sa Priority. */
+  Priority priority{ Priority::eNormal };
+
+  /** \brief The key for Requester::Config::hostLimits.
+
+      If empty, the default, the host name from \a url is used. Set this to
+      share limits between several hosts, e.g. for a partner API with a
+      single rate limit served from several domains.
+   */
+  std::string rateLimitKey;
+
+  enum class SinkStatus
+  {
+    eContinue,
+    ePause     //!< The data was not consumed, \sa BodySink.
+  };
+
+  /** \brief Receives the response body as it arrives.
+
+      If set, the body is passed here chunk by chunk on the Requester thread
+      rather than being collected into Response::content, which will be empty.
+
+      If the consumer falls behind it can return \a ePause. The transfer is
+      then paused and the chunk is not consumed; it will be passed again once
+      the transfer is resumed with RequestHandle::resume, which may be called
+      from any thread.
+
+      Requests with a body sink are neither retried nor hedged as the sink
+      would see the body more than once.
+   */
+  using BodySink = std::function< SinkStatus( std::string_view data ) >;
+  BodySink bodySink;
+
+  /** \brief The body to upload for ePut.
+
+      Also sent for ePost if neither \a postUrlEncodedValues nor \a mimePost
+      are set.
+   */
+  Body body;
+
+  /** \brief Compress the request body on the fly.
+
+      Applies to \a postUrlEncodedValues and \a body, which are sent with a
+      Content-Encoding header, and to each part of \a mimePost, which are sent
+      with a Content-Encoding part header. The data is compressed as it is
+      read so the compressed body is never held in memory. As its size is not
+      known up front it is sent using chunked transfer encoding.
+
+      Bodies, or parts, smaller than \a minNumBytes are sent uncompressed.
+      Those of unknown size, e.g. a Body::stream, are always compressed.
+
+      The number of bytes before and after compression are reported in
+      Response::uncompressedBodyNumBytes and Response::compressedBodyNumBytes.
+   */
+  struct Compression
+  {
+    enum class Encoding
+    {
+      eNone,
+      eGzip,
+      eZstd  //!< Only if built with zstd support, \sa isSupported.
+    } encoding{ Encoding::eNone };
+
+    size_t minNumBytes{ 1024 };
+
+    int level{ 0 }; //!< Zero for the default level of the encoding.
+
+    /** \brief Whether the library was built with support for \a encoding.
+
+        If not then bodies are sent uncompressed.
+     */
+    static bool isSupported( Encoding );
+  } compression;
+
+  /** \brief The profile in Requester::Config::tuningProfiles to use.
+
+      If empty, the default, then Requester::Config::tuningProfile is used.
+   */
+  std::string tuningProfile;
+
+  /** \brief Settings that override those of the tuning profile. */
+  ConnectionTuning tuning;
+
+  /** \brief The template this request was created from, if any.
+
+      Set by PreparedRequest::create so that its base URL and headers can be
+      reused rather than parsed and built again. Only used whilst \a url is
+      empty.
+   */
+  struct Prepared
+  {
+    PreparedRequest from;
+    std::string path;   //!< The full path, set on a copy of the base URL.
+    std::string query;  //!< The full query, empty for none.
+  } prepared;
 };
 
 
+/** \brief Encode \a pairs straight into Request::postUrlEncodedValues, \sa
+           encodeForm in UrlEncodedValuesCreator.h.
+ */
+template<typename Range>
+void encodeForm( const Range& pairs, Request& request )
+{
+  encodeForm( pairs, request.postUrlEncodedValues );
+}
+
+
 } // End of namespace http
 
 
@@ -18,9 +18,9 @@
     along with this program.  If not, see <https://www.gnu.org/licenses/>.
 */
 
+#include <lb/url/MoveOnlyFunction.h>
 #include <lb/url/ResponseCode.h>
 
-#include <functional>
 #include <string>
 #include <vector>
 
@@ -47,10 +47,30 @@ struct Response
   Response( const Response& ) = delete;
   Response& operator=( const Response& ) = delete;
 
-  using Callback = std::function< void(ResponseCode, Response) >;
+  /** \brief Invoked once on completion, \sa MoveOnlyFunction.
+
+      May capture move-only state, e.g. a std::promise, and small captures are
+      stored without allocating.
+   */
+  using Callback = MoveOnlyFunction< void(ResponseCode, Response) >;
 
   unsigned int code; //!< e.g. 200, 404, etc.
   std::string content;
+
+  //! Number of attempts made, more than one if the request was retried.
+  unsigned int numAttempts{ 1 };
+
+  //! Time spent queued in Requester waiting for capacity or rate limits.
+  size_t queueWaitMicroseconds{ 0 };
+
+  /** \brief Size of the request body before and after compression.
+
+      Both are zero if the body was not compressed, \sa Request::compression.
+      If the body had to be sent more than once, e.g. the request was retried,
+      then these are the totals.
+   */
+  size_t uncompressedBodyNumBytes{ 0 };
+  size_t compressedBodyNumBytes{ 0 };
 };
 
 
@@ -18,7 +18,8 @@
     along with this program.  If not, see <https://www.gnu.org/licenses/>.
 */
 
-#include <sstream>
+#include <string>
+#include <string_view>
 
 
 namespace lb
@@ -33,6 +34,13 @@ namespace http
 {
 
 
+/** \brief Builds application/x-www-form-urlencoded data, \sa
+           Request::postUrlEncodedValues.
+
+    The data is built in a single buffer. If you know roughly how big it will
+    be then reserve the space up front, and move the data out with
+    std::move( creator ).str() once done, so that it is never copied.
+ */
 class UrlEncodedValuesCreator
 {
 public:
@@ -44,32 +52,111 @@ public:
    */
   struct Encodable
   {
-    Encodable() = default;
-
     std::string s;
     bool needsEncoded{ true };
   };
 
   /** \brief Add a {field, value} pair, optionally encoding them.
              Value may be empty but field must not.
-      \return False if the field is empty or the encoding failed.
+      \return False if the field is empty.
   */
   bool add( const Encodable& field, const Encodable& value );
 
+  /** \brief Reserve space for \a numBytes of encoded data in total. */
+  void reserve( size_t numBytes );
+
   /** \brief Return the full string as it currently stands. */
-  std::string str() const;
+  std::string str() const &;
+
+  /** \brief Move the full string out, leaving this creator empty. */
+  std::string str() &&;
 
   /** \brief Reset the string back to the empty string. */
   void clear();
 
+  /** \brief The number of bytes \a s takes once URL encoded. */
+  static size_t encodedSize( std::string_view s );
+
+  /** \brief URL encode \a s into \a out, which must have encodedSize( s ) bytes.
+      \return The end of the encoded data.
+   */
+  static char* encode( std::string_view s, char* out );
+
 private:
-  std::stringstream ss;
-  bool empty{ true };
+  std::string buffer;
 
-  bool addEncodable( const Encodable& );
+  void addEncodable( const Encodable& );
 };
 
 
+/** \brief Encode \a pairs as application/x-www-form-urlencoded data into
+           \a out, replacing its contents.
+
+    \a pairs is any range, that can be iterated more than once, of pairs whose
+    field and value convert to std::string_view, e.g. a std::map of strings or
+    a std::vector of std::pair<const char*, std::string>. Anything that can be
+    bound with structured bindings as [ field, value ] will do.
+
+    Both fields and values are encoded. Pairs with an empty field are skipped,
+    as UrlEncodedValuesCreator::add refuses them.
+
+    The exact encoded size is computed first so \a out is allocated at most
+    once, and not at all if it already has the capacity.
+ */
+template<typename Range>
+void encodeForm( const Range& pairs, std::string& out )
+{
+  size_t numBytes{ 0 };
+  bool first{ true };
+  for ( const auto& [ field, value ] : pairs )
+  {
+    const std::string_view f{ field };
+    if ( f.empty() )
+    {
+      continue;
+    }
+    numBytes += ( first ? 0 : 1 ) // '&'
+              + UrlEncodedValuesCreator::encodedSize( f )
+              + 1                 // '='
+              + UrlEncodedValuesCreator::encodedSize( value );
+    first = false;
+  }
+
+  out.clear();
+  out.resize( numBytes );
+
+  char* p{ out.data() };
+  first = true;
+  for ( const auto& [ field, value ] : pairs )
+  {
+    const std::string_view f{ field };
+    if ( f.empty() )
+    {
+      continue;
+    }
+    if ( !first )
+    {
+      *p++ = '&';
+    }
+    p = UrlEncodedValuesCreator::encode( f, p );
+    *p++ = '=';
+    p = UrlEncodedValuesCreator::encode( value, p );
+    first = false;
+  }
+}
+
+/** \brief Encode \a pairs into a new string, \sa encodeForm above.
+
+    See Request.h for an overload that encodes straight into a Request.
+ */
+template<typename Range>
+std::string encodeForm( const Range& pairs )
+{
+  std::string out;
+  encodeForm( pairs, out );
+  return out;
+}
+
 } // End of namespace http
 
 
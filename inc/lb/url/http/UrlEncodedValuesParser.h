@@ -0,0 +1,182 @@
+#ifndef LIB_LB_URL_HTTP_URLENCODEDVALUESPARSER_H
+#define LIB_LB_URL_HTTP_URLENCODEDVALUESPARSER_H
+
+/*
+    Copyright (C) 2023  Paul Fotheringham (LinuxBrickie)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <cstddef>
+#include <iterator>
+#include <string>
+#include <string_view>
+
+
+namespace lb
+{
+
+
+namespace url
+{
+
+
+namespace http
+{
+
+
+/** \brief Iterates the {field, value} pairs of application/x-www-form-urlencoded
+           data, e.g. a form or a query string.
+
+    The counterpart of UrlEncodedValuesCreator. Nothing is allocated or
+    copied; the pairs are views of the data.
+
+    \code
+    for ( const auto& [ field, value ] : UrlEncodedValuesParser{ data } )
+    \endcode
+
+    The pairs are as encoded and can be decoded with decode, or use
+    UrlEncodedValuesDecoder to decode them in place.
+
+    Pairs are separated by '&' and empty ones are skipped. A pair without an
+    '=' is a field with an empty value.
+ */
+class UrlEncodedValuesParser
+{
+public:
+  struct Pair
+  {
+    std::string_view field;
+    std::string_view value;
+  };
+
+  /** \brief Iterate the still encoded pairs of \a data. */
+  explicit UrlEncodedValuesParser( std::string_view data );
+
+  class Iterator
+  {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = Pair;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const Pair*;
+    using reference = const Pair&;
+
+    Iterator() = default;
+
+    reference operator*() const { return pair; }
+    pointer operator->() const { return &pair; }
+
+    Iterator& operator++();
+    Iterator operator++( int );
+
+    bool operator==( const Iterator& rhs ) const { return ( atEnd == rhs.atEnd ) && ( atEnd || ( rest.data() == rhs.rest.data() ) ); }
+    bool operator!=( const Iterator& rhs ) const { return !( *this == rhs ); }
+
+  private:
+    friend class UrlEncodedValuesParser;
+
+    explicit Iterator( std::string_view data );
+
+    std::string_view rest;       //!< After the current pair.
+    Pair pair;
+    bool atEnd{ true };
+  };
+
+  Iterator begin() const;
+  Iterator end() const;
+
+  /** \brief Decode \a encoded into \a out, which must have room for
+             encoded.size() bytes.
+      \return The decoded data, which is a view of \a out.
+
+      Percent-encoded bytes are decoded and '+' becomes a space. A '%' that is
+      not followed by two hex digits is left as-is.
+
+      \a out may be encoded.data() to decode in place as the decoded data is
+      never longer than the encoded data.
+   */
+  static std::string_view decode( std::string_view encoded, char* out );
+
+  /** \brief Decode \a encoded into a new string, \sa decode. */
+  static std::string decode( std::string_view encoded );
+
+private:
+  std::string_view data;
+};
+
+
+/** \brief Iterates the {field, value} pairs of application/x-www-form-urlencoded
+           data as UrlEncodedValuesParser does but decodes each in place.
+
+    Each pair is decoded as it is reached, within the bytes it was encoded in,
+    so the buffer can only be iterated once. The iterator is therefore only an
+    input iterator.
+ */
+class UrlEncodedValuesDecoder
+{
+public:
+  using Pair = UrlEncodedValuesParser::Pair;
+
+  UrlEncodedValuesDecoder( char* data, size_t numBytes );
+
+  class Iterator
+  {
+  public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = Pair;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const Pair*;
+    using reference = const Pair&;
+
+    Iterator() = default;
+
+    reference operator*() const { return pair; }
+    pointer operator->() const { return &pair; }
+
+    Iterator& operator++();
+    Iterator operator++( int );
+
+    bool operator==( const Iterator& rhs ) const { return encoded == rhs.encoded; }
+    bool operator!=( const Iterator& rhs ) const { return !( *this == rhs ); }
+
+  private:
+    friend class UrlEncodedValuesDecoder;
+
+    explicit Iterator( UrlEncodedValuesParser::Iterator encoded );
+
+    void decode();
+
+    UrlEncodedValuesParser::Iterator encoded;
+    Pair pair;
+  };
+
+  Iterator begin() const;
+  Iterator end() const;
+
+private:
+  UrlEncodedValuesParser parser;
+};
+
+
+} // End of namespace http
+
+
+} // End of namespace url
+
+
+} // End of namespace lb
+
+
+#endif // LIB_LB_URL_HTTP_URLENCODEDVALUESPARSER_H
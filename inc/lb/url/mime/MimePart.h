@@ -19,7 +19,9 @@
 */
 
 #include <functional>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
 
@@ -70,13 +72,13 @@ struct MimePart
   /** \brief The name part of the {name, data} pair. */
   std::string name;
 
-  // Use either data OR dataReader
+  // Use one of data, sharedData, dataView, file or dataReader. If more than
+  // one is set then dataReader takes precedence, then file, then sharedData,
+  // then dataView.
 
-  /** \brief The data to be sent. This will be copied before sending.
+  /** \brief The part's data, handled as for http::Body::data.
 
       Does not have to be null terminated.
-
-      If this is memory intensive then \sa dataReader.
    */
   std::string data;
 
@@ -99,6 +101,13 @@ struct MimePart
 
         You must (obviously) keep track of where you are in the read so you can
         resume in the next call. \sa
+
+        If no data is available yet return \a rcReadPause rather than blocking
+        the \a Requester's thread. Once more data is available call
+        RequestHandle::resume, from any thread, with the handle returned by
+        Requester::makeRequest and the callback is invoked again. Resuming a
+        transfer that is not paused does nothing so it is safe to call after
+        every write of new data.
      */
     using DataReadFunction = std::function< size_t( char* buffer, size_t numBytes ) >;
     DataReadFunction dataReadFn;
@@ -119,7 +128,7 @@ struct MimePart
     size_t totalNumBytes{ 0 };
 
     static const size_t rcReadAbort;
-    static const size_t rcReadPause;
+    static const size_t rcReadPause; //!< Until RequestHandle::resume is called.
 
     static const int seekOriginSet;
     static const int seekOriginCur;
@@ -131,6 +140,45 @@ struct MimePart
   } dataReader;
 
   Headers headers;
+
+  /** \brief The part's data, shared as for http::Body::sharedData. */
+  std::shared_ptr<const std::string> sharedData;
+
+  /** \brief Data owned by the caller. Never copied.
+
+      You must guarantee that the data outlives the request, i.e. until the
+      response callback has been invoked.
+   */
+  std::string_view dataView;
+
+  /** \brief Upload a region of a file without reading it into memory first.
+
+      The file is read lazily as libcurl asks for data, either with pread or
+      from a read-only memory mapping, so memory use is constant regardless of
+      the size of the file. Either way the data comes straight from the page
+      cache and rewinds for retries or redirects are supported.
+
+      The file is opened, or \a fd duplicated, when the request is made. If
+      that fails, or the region does not lie within the file, then
+      Requester::makeRequest throws std::runtime_error.
+
+      Also used for the body of a request, \sa http::Body::file.
+   */
+  struct File
+  {
+    std::string path;          //!< Opened read-only if \a fd is not set.
+    int fd{ -1 };              //!< Duplicated so may be closed once the request is made.
+    size_t offset{ 0 };
+    size_t numBytes{ 0 };      //!< Zero for everything from \a offset to the end of the file.
+    bool memoryMap{ false };   //!< Map the region rather than using pread.
+
+    /** \brief The filename sent in the part's Content-Disposition header.
+
+        Defaults to the last component of \a path. If both are empty then no
+        filename is sent. Not used for an http::Body.
+     */
+    std::string fileName;
+  } file;
 };
 
 
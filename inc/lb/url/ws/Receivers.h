@@ -25,6 +25,7 @@
 #include <lb/url/ws/ConnectionID.h>
 #include <lb/url/ws/ControlOpCode.h>
 #include <lb/url/ws/DataOpCode.h>
+#include <lb/url/MoveOnlyFunction.h>
 
 
 namespace lb
@@ -45,8 +46,10 @@ namespace ws
 
     Fragmented (data) messages are reassembled by Requester so that what you
     receive via \a receiveData is the complete message, you do not get access
-    to the individual frames. WARNING: That said libcurl curently has a bug
-    that means that fragmented messages do not work.
+    to the individual frames. The message is only valid for the duration of
+    the call as its buffer is reused for the next message on the connection.
+    Reassembly relies on libcurl flagging every frame of a message but the
+    last with CURLWS_CONT, as recent versions do.
 
     Control messages are never fragmented so you receive the payload of the
     control frame directly in \a receiveControl. Note that control messages
@@ -58,8 +61,9 @@ namespace ws
 class Receivers
 {
 public:
-  using DataReceiver    = std::function<void( ConnectionID, DataOpCode, const std::string& )>;
-  using ControlReceiver = std::function<void( ConnectionID, ControlOpCode, const std::string& )>;
+  // May capture move-only state, \sa MoveOnlyFunction.
+  using DataReceiver    = MoveOnlyFunction<void( ConnectionID, DataOpCode, const std::string& )>;
+  using ControlReceiver = MoveOnlyFunction<void( ConnectionID, ControlOpCode, const std::string& )>;
 
   Receivers( DataReceiver, ControlReceiver );
 
@@ -68,9 +72,9 @@ public:
   Receivers( const Receivers& ) = default;
   Receivers& operator=( const Receivers& ) = default;
 
-  bool receiveData( ConnectionID id, DataOpCode opCode, std::string message );
+  bool receiveData( ConnectionID id, DataOpCode opCode, const std::string& message );
 
-  bool receiveControl( ConnectionID id, ControlOpCode opCode, std::string payload );
+  bool receiveControl( ConnectionID id, ControlOpCode opCode, const std::string& payload );
 
   /** \brief Called by the request maker when it can no longer receive anything.
 
@@ -70,6 +70,16 @@ struct Request
   Receivers receivers;
 
   size_t closeTimeoutMilliseconds{ 2000 };
+
+  /** \brief The most bytes read from the connection in one go.
+
+      Once the size of a frame is known the rest of it is read straight into a
+      message buffer that is kept for the lifetime of the connection and reused
+      for each message, so once it has grown to fit the largest message
+      receiving allocates nothing. Larger reads mean fewer calls into libcurl
+      for large messages.
+   */
+  size_t receiveBufferSize{ 64 * 1024 };
 };
 
 
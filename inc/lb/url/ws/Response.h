@@ -18,12 +18,11 @@
     along with this program.  If not, see <https://www.gnu.org/licenses/>.
 */
 
+#include <lb/url/MoveOnlyFunction.h>
 #include <lb/url/ResponseCode.h>
 #include <lb/url/ws/ConnectionID.h>
 #include <lb/url/ws/Senders.h>
 
-#include <functional>
-
 
 namespace lb
 {
@@ -55,7 +54,7 @@ struct Response
   Response( const Response& ) = delete;
   Response& operator=( const Response& ) = delete;
 
-  using Callback = std::function< void(ResponseCode, Response) >;
+  using Callback = MoveOnlyFunction< void(ResponseCode, Response) >; //!< \sa http::Response::Callback
 
   /** \brief The unique identifier for the connection.
 
@@ -18,6 +18,7 @@
     along with this program.  If not, see <https://www.gnu.org/licenses/>.
 */
 
+#include <functional>
 #include <future>
 #include <memory>
 #include <string>
@@ -73,6 +74,18 @@ public:
   std::future<SendResult> sendPing( std::string payload ) const;
   std::future<SendResult> sendPong( std::string payload ) const;
 
+  /** \brief Invoked with the result of a send instead of fulfilling a future.
+
+      Called on the Requester thread once the send has been attempted, or
+      immediately on the calling thread if sending is no longer possible.
+   */
+  using Callback = std::function< void( SendResult ) >;
+
+  void sendData( DataOpCode, std::string message, Callback, size_t maxFrameSize = UNLIMITED_FRAME_SIZE ) const;
+  void sendClose( encoding::websocket::closestatus::PayloadCode, std::string reason, Callback ) const;
+  void sendPing( std::string payload, Callback ) const;
+  void sendPong( std::string payload, Callback ) const;
+
   struct Impl; //!< Opaque implementation detail.
 
 private:
@@ -0,0 +1,159 @@
+/*
+    Copyright (C) 2023  Paul Fotheringham (LinuxBrickie)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "AdmissionQueue.h"
+
+#include <algorithm>
+
+
+namespace lb
+{
+
+
+namespace url
+{
+
+
+AdmissionQueue::AdmissionQueue( std::chrono::milliseconds t )
+  : starvationTimeout{ t }
+{
+}
+
+void AdmissionQueue::push( std::unique_ptr<RequestHandler> request )
+{
+  Queues& queues{ queuesByKey[ request->hostKey() ] };
+  queues[ size_t( request->priority() ) ].push_back( { Clock::now(), std::move( request ) } );
+}
+
+AdmissionQueue::Admission AdmissionQueue::pop( const CanAdmit& canAdmit )
+{
+  // The oldest request that has starved takes precedence, otherwise the
+  // oldest request of the highest priority.
+  const auto now{ Clock::now() };
+  const auto starvedBefore{ now - starvationTimeout };
+
+  auto K{ queuesByKey.end() };
+  std::deque<Entry>* next{ nullptr };
+  size_t nextPriority{ 0 };
+  bool nextStarved{ false };
+
+  for ( auto Q = queuesByKey.begin(); Q != queuesByKey.end(); ++Q )
+  {
+    if ( !canAdmit( Q->first ) )
+    {
+      continue;
+    }
+
+    for ( size_t priority = 0; priority < numPriorities; ++priority )
+    {
+      auto& queue{ Q->second[ priority ] };
+      if ( queue.empty() )
+      {
+        continue;
+      }
+
+      const auto enqueued{ queue.front().enqueued };
+      const bool starved{ enqueued <= starvedBefore };
+
+      bool better{ !next };
+      if ( next )
+      {
+        if ( starved != nextStarved )
+        {
+          better = starved;
+        }
+        else if ( !starved && ( priority != nextPriority ) )
+        {
+          better = priority > nextPriority;
+        }
+        else
+        {
+          better = enqueued < next->front().enqueued;
+        }
+      }
+
+      if ( better )
+      {
+        K = Q;
+        next = &queue;
+        nextPriority = priority;
+        nextStarved = starved;
+      }
+    }
+  }
+
+  if ( !next )
+  {
+    return {};
+  }
+
+  auto request{ std::move( next->front().request ) };
+  const auto enqueued{ next->front().enqueued };
+  next->pop_front();
+
+  bool keyEmpty{ true };
+  for ( const auto& queue : K->second )
+  {
+    keyEmpty = keyEmpty && queue.empty();
+  }
+  if ( keyEmpty )
+  {
+    queuesByKey.erase( K );
+  }
+
+  return { std::move( request ), now - enqueued };
+}
+
+std::unique_ptr<RequestHandler> AdmissionQueue::remove( size_t id )
+{
+  for ( auto K = queuesByKey.begin(); K != queuesByKey.end(); ++K )
+  {
+    for ( auto& queue : K->second )
+    {
+      const auto E{ std::find_if( queue.begin(), queue.end()
+                                , [id]( const Entry& e ) { return e.request->getId() == id; } ) };
+      if ( E == queue.end() )
+      {
+        continue;
+      }
+
+      auto request{ std::move( E->request ) };
+      queue.erase( E );
+
+      if ( std::all_of( K->second.begin(), K->second.end()
+                      , []( const std::deque<Entry>& q ) { return q.empty(); } ) )
+      {
+        queuesByKey.erase( K );
+      }
+
+      return request;
+    }
+  }
+
+  return {};
+}
+
+bool AdmissionQueue::empty() const
+{
+  return queuesByKey.empty();
+}
+
+
+} // End of namespace url
+
+
+} // End of namespace lb
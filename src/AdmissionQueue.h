@@ -0,0 +1,105 @@
+#ifndef LIB_LB_URL_ADMISSIONQUEUE_H
+#define LIB_LB_URL_ADMISSIONQUEUE_H
+
+/*
+    Copyright (C) 2023  Paul Fotheringham (LinuxBrickie)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// Private header
+
+#include <lb/url/Priority.h>
+
+#include "RequestHandler.h"
+
+#include <array>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+
+namespace lb
+{
+
+
+namespace url
+{
+
+
+/** \brief Requests waiting to be admitted to the curl multi handle.
+
+    Requests are admitted highest Priority first and oldest first within a
+    priority. To stop low priority requests from starving, a request that has
+    waited at least the starvation timeout is admitted ahead of anything else.
+
+    Requests are also grouped by RequestHandler::hostKey so that requests for
+    a host that is at its limits do not hold up requests for other hosts.
+
+    Only ever used on the Requester thread so there is no locking.
+ */
+class AdmissionQueue
+{
+public:
+  using Clock = std::chrono::steady_clock;
+
+  AdmissionQueue( std::chrono::milliseconds starvationTimeout );
+
+  void push( std::unique_ptr<RequestHandler> );
+
+  using CanAdmit = std::function< bool( const std::string& limitKey ) >;
+
+  struct Admission
+  {
+    std::unique_ptr<RequestHandler> request; //!< Null if nothing can be admitted.
+    Clock::duration queueWait;
+  };
+
+  /** \brief Remove the next request to admit that \a canAdmit allows. */
+  Admission pop( const CanAdmit& canAdmit );
+
+  /** \brief Remove the request with RequestHandler::getId \a id, if queued. */
+  std::unique_ptr<RequestHandler> remove( size_t id );
+
+  bool empty() const;
+
+private:
+  struct Entry
+  {
+    Clock::time_point enqueued;
+    std::unique_ptr<RequestHandler> request;
+  };
+
+  static const size_t numPriorities{ size_t( Priority::eCritical ) + 1 };
+
+  //! One queue per priority, indexed by Priority.
+  using Queues = std::array< std::deque<Entry>, numPriorities >;
+
+  const std::chrono::milliseconds starvationTimeout;
+
+  //! Keyed by RequestHandler::hostKey. Keys are removed once empty.
+  std::unordered_map< std::string, Queues > queuesByKey;
+};
+
+
+} // End of namespace url
+
+
+} // End of namespace lb
+
+
+#endif // LIB_LB_URL_ADMISSIONQUEUE_H
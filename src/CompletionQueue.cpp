@@ -0,0 +1,186 @@
+/*
+    Copyright (C) 2023  Paul Fotheringham (LinuxBrickie)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "CompletionQueue.h"
+
+
+namespace lb
+{
+
+
+namespace url
+{
+
+
+static size_t roundUpToPowerOfTwo( size_t n )
+{
+  size_t powerOfTwo{ 2 };
+  while ( powerOfTwo < n )
+  {
+    powerOfTwo *= 2;
+  }
+  return powerOfTwo;
+}
+
+
+CompletionQueue::CompletionQueue( size_t capacity, std::function< void() > s )
+  : mask{ roundUpToPowerOfTwo( capacity ) - 1 }
+  , cells{ new Cell[ mask + 1 ] }
+  , spaceAvailable{ std::move( s ) }
+{
+  for ( size_t i = 0; i <= mask; ++i )
+  {
+    cells[ i ].sequence.store( i, std::memory_order_relaxed );
+  }
+}
+
+CompletionQueue::~CompletionQueue() = default;
+
+void CompletionQueue::push( Completion completion )
+{
+  // Keep completions in order, never jump the overflow.
+  if ( !overflow.empty() || !tryPush( completion ) )
+  {
+    overflow.push_back( std::move( completion ) );
+    overflowing.store( true );
+  }
+  pushedSinceFlush = true;
+}
+
+void CompletionQueue::flush()
+{
+  while ( !overflow.empty() && tryPush( overflow.front() ) )
+  {
+    overflow.pop_front();
+    pushedSinceFlush = true;
+  }
+  overflowing.store( !overflow.empty() );
+
+  if ( !pushedSinceFlush )
+  {
+    return;
+  }
+  pushedSinceFlush = false;
+
+  // Pairs with the increment in pop() so that either the consumer sees the
+  // completions or we see the consumer.
+  std::atomic_thread_fence( std::memory_order_seq_cst );
+  if ( numWaiting.load( std::memory_order_relaxed ) > 0 )
+  {
+    // Taking the lock means a consumer cannot be between checking the ring
+    // and going to sleep, so the notification cannot be missed.
+    { std::scoped_lock l{ waitMutex }; }
+    waitCondition.notify_all();
+  }
+}
+
+size_t CompletionQueue::pop( Completion* completions, size_t maxNumCompletions, std::chrono::milliseconds timeout )
+{
+  if ( maxNumCompletions == 0 )
+  {
+    return 0;
+  }
+
+  size_t numPopped{ popAvailable( completions, maxNumCompletions ) };
+  if ( ( numPopped > 0 ) || ( timeout.count() <= 0 ) )
+  {
+    return numPopped;
+  }
+
+  numWaiting.fetch_add( 1 );
+  std::atomic_thread_fence( std::memory_order_seq_cst );
+  {
+    std::unique_lock l{ waitMutex };
+    waitCondition.wait_for( l, timeout, [&]()
+    {
+      numPopped = popAvailable( completions, maxNumCompletions );
+      return numPopped > 0;
+    } );
+  }
+  numWaiting.fetch_sub( 1 );
+
+  return numPopped;
+}
+
+size_t CompletionQueue::popAvailable( Completion* completions, size_t maxNumCompletions )
+{
+  size_t numPopped{ 0 };
+  while ( ( numPopped < maxNumCompletions ) && tryPop( completions[ numPopped ] ) )
+  {
+    ++numPopped;
+  }
+
+  if ( ( numPopped > 0 ) && overflowing.load() && spaceAvailable )
+  {
+    spaceAvailable();
+  }
+
+  return numPopped;
+}
+
+bool CompletionQueue::tryPush( Completion& completion )
+{
+  // Single producer so no need to compete for the position.
+  const size_t position{ enqueuePosition.load( std::memory_order_relaxed ) };
+  Cell& cell{ cells[ position & mask ] };
+  if ( cell.sequence.load( std::memory_order_acquire ) != position )
+  {
+    return false; // Full
+  }
+
+  cell.completion = std::move( completion );
+  cell.sequence.store( position + 1, std::memory_order_release );
+  enqueuePosition.store( position + 1, std::memory_order_relaxed );
+  return true;
+}
+
+bool CompletionQueue::tryPop( Completion& completion )
+{
+  size_t position{ dequeuePosition.load( std::memory_order_relaxed ) };
+  for (;;)
+  {
+    Cell& cell{ cells[ position & mask ] };
+    const size_t sequence{ cell.sequence.load( std::memory_order_acquire ) };
+    const auto difference{ static_cast<std::ptrdiff_t>( sequence - ( position + 1 ) ) };
+    if ( difference == 0 )
+    {
+      if ( dequeuePosition.compare_exchange_weak( position, position + 1, std::memory_order_relaxed ) )
+      {
+        completion = std::move( cell.completion );
+        cell.completion = {};
+        // Free for the producer's next lap around the ring.
+        cell.sequence.store( position + mask + 1, std::memory_order_release );
+        return true;
+      }
+      // position was updated by the failed exchange.
+    }
+    else if ( difference < 0 )
+    {
+      return false; // Empty
+    }
+    else
+    {
+      position = dequeuePosition.load( std::memory_order_relaxed );
+    }
+  }
+}
+
+
+} // End of namespace url
+
+
+} // End of namespace lb
@@ -0,0 +1,121 @@
+#ifndef LIB_LB_URL_COMPLETIONQUEUE_H
+#define LIB_LB_URL_COMPLETIONQUEUE_H
+
+/*
+    Copyright (C) 2023  Paul Fotheringham (LinuxBrickie)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// Private header
+
+#include <lb/url/Requester.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+
+namespace lb
+{
+
+
+namespace url
+{
+
+
+/** \brief Completed requests awaiting collection, \sa Requester::pollCompletions.
+
+    A bounded lock-free ring with a single producer, the Requester thread, and
+    any number of consumers. Each slot carries a sequence number that says
+    whether it is free to write or ready to read (Vyukov's bounded queue) so
+    consumers only contend on a single counter.
+
+    The Requester thread never blocks. If the ring is full completions wait in
+    an overflow list until consumers have made space.
+
+    Sleeping consumers are only woken by \a flush, which the Requester calls
+    once per loop iteration, so a batch of completions costs one wakeup.
+ */
+class CompletionQueue
+{
+public:
+  using Completion = Requester::Completion;
+
+  /** \param capacity Rounded up to a power of two.
+      \param spaceAvailable Called by a consumer that made space whilst there
+                            were completions waiting in the overflow list.
+   */
+  CompletionQueue( size_t capacity, std::function< void() > spaceAvailable );
+  ~CompletionQueue();
+
+  CompletionQueue( const CompletionQueue& ) = delete;
+  CompletionQueue& operator=( const CompletionQueue& ) = delete;
+
+  /** \brief Queue \a completion. Only called on the Requester thread. */
+  void push( Completion completion );
+
+  /** \brief Move any overflow into the ring and wake consumers if anything was
+             pushed since the last flush. Only called on the Requester thread.
+   */
+  void flush();
+
+  /** \brief Remove up to \a maxNumCompletions, waiting up to \a timeout for
+             at least one. Called from any thread.
+   */
+  size_t pop( Completion* completions, size_t maxNumCompletions, std::chrono::milliseconds timeout );
+
+private:
+  bool tryPush( Completion& completion );
+  bool tryPop( Completion& completion );
+  size_t popAvailable( Completion* completions, size_t maxNumCompletions );
+
+  struct Cell
+  {
+    std::atomic<size_t> sequence;
+    Completion completion;
+  };
+
+  const size_t mask;
+  std::unique_ptr<Cell[]> cells;
+
+  // Written by different threads so kept on separate cache lines.
+  alignas( 64 ) std::atomic<size_t> enqueuePosition{ 0 };
+  alignas( 64 ) std::atomic<size_t> dequeuePosition{ 0 };
+
+  //! Only accessed on the Requester thread.
+  std::deque<Completion> overflow;
+  bool pushedSinceFlush{ false };
+
+  std::atomic<bool> overflowing{ false };
+  std::function< void() > spaceAvailable;
+
+  // Only used to put consumers to sleep, never to access the ring.
+  std::mutex waitMutex;
+  std::condition_variable waitCondition;
+  std::atomic<size_t> numWaiting{ 0 };
+};
+
+
+} // End of namespace url
+
+
+} // End of namespace lb
+
+
+#endif // LIB_LB_URL_COMPLETIONQUEUE_H
@@ -0,0 +1,313 @@
+/*
+    Copyright (C) 2023  Paul Fotheringham (LinuxBrickie)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "Compressor.h"
+
+#include <curl/curl.h>
+
+#include <stdexcept>
+
+#include <zlib.h>
+
+#ifdef LB_URL_WITH_ZSTD
+#include <zstd.h>
+#endif
+
+
+namespace lb
+{
+
+
+namespace url
+{
+
+
+static const size_t inputNumBytesMax{ 64 * 1024 };
+
+
+/** \brief gzip using zlib. */
+class GzipCompressor : public Compressor
+{
+public:
+  GzipCompressor( int level )
+  {
+    // 16 added to the window bits gives a gzip rather than zlib wrapper.
+    if ( deflateInit2( &stream, ( level == 0 ) ? Z_DEFAULT_COMPRESSION : level
+                     , Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY ) != Z_OK )
+    {
+      throw std::runtime_error( "Failed to initialise gzip compression." );
+    }
+  }
+
+  ~GzipCompressor()
+  {
+    deflateEnd( &stream );
+  }
+
+  const char* name() const override
+  {
+    return "gzip";
+  }
+
+protected:
+  Result compress( const char* in, size_t inNumBytes, char* out, size_t outNumBytes, Flush flush ) override
+  {
+    stream.next_in = (Bytef*)in;
+    stream.avail_in = uInt( inNumBytes );
+    stream.next_out = (Bytef*)out;
+    stream.avail_out = uInt( outNumBytes );
+
+    int mode{ Z_NO_FLUSH };
+    switch( flush )
+    {
+    case Flush::eNone:   mode = Z_NO_FLUSH;   break;
+    case Flush::eSync:   mode = Z_SYNC_FLUSH; break;
+    case Flush::eFinish: mode = Z_FINISH;     break;
+    }
+
+    const int rc{ deflate( &stream, mode ) };
+
+    Result result;
+    result.ok = ( rc == Z_OK ) || ( rc == Z_STREAM_END ) || ( rc == Z_BUF_ERROR );
+    result.numConsumed = inNumBytes - stream.avail_in;
+    result.numProduced = outNumBytes - stream.avail_out;
+    result.done = ( flush == Flush::eFinish ) ? ( rc == Z_STREAM_END )
+                                              : ( stream.avail_out > 0 );
+    return result;
+  }
+
+  bool restart() override
+  {
+    return deflateReset( &stream ) == Z_OK;
+  }
+
+private:
+  z_stream stream{};
+};
+
+
+#ifdef LB_URL_WITH_ZSTD
+/** \brief zstd streaming compression. */
+class ZstdCompressor : public Compressor
+{
+public:
+  ZstdCompressor( int level )
+    : context{ ZSTD_createCCtx() }
+  {
+    if ( !context )
+    {
+      throw std::runtime_error( "Failed to initialise zstd compression." );
+    }
+    if ( level != 0 )
+    {
+      ZSTD_CCtx_setParameter( context, ZSTD_c_compressionLevel, level );
+    }
+  }
+
+  ~ZstdCompressor()
+  {
+    ZSTD_freeCCtx( context );
+  }
+
+  const char* name() const override
+  {
+    return "zstd";
+  }
+
+protected:
+  Result compress( const char* in, size_t inNumBytes, char* out, size_t outNumBytes, Flush flush ) override
+  {
+    ZSTD_inBuffer input{ in, inNumBytes, 0 };
+    ZSTD_outBuffer output{ out, outNumBytes, 0 };
+
+    ZSTD_EndDirective mode{ ZSTD_e_continue };
+    switch( flush )
+    {
+    case Flush::eNone:   mode = ZSTD_e_continue; break;
+    case Flush::eSync:   mode = ZSTD_e_flush;    break;
+    case Flush::eFinish: mode = ZSTD_e_end;      break;
+    }
+
+    const size_t remaining{ ZSTD_compressStream2( context, &output, &input, mode ) };
+
+    Result result;
+    result.ok = !ZSTD_isError( remaining );
+    result.numConsumed = input.pos;
+    result.numProduced = output.pos;
+    result.done = result.ok && ( remaining == 0 ) && ( input.pos == input.size );
+    return result;
+  }
+
+  bool restart() override
+  {
+    return !ZSTD_isError( ZSTD_CCtx_reset( context, ZSTD_reset_session_only ) );
+  }
+
+private:
+  ZSTD_CCtx* context;
+};
+#endif
+
+
+// static
+std::unique_ptr<Compressor> Compressor::create( Encoding encoding, int level )
+{
+  switch( encoding )
+  {
+  case Encoding::eNone:
+    break;
+  case Encoding::eGzip:
+    return std::make_unique<GzipCompressor>( level );
+  case Encoding::eZstd:
+#ifdef LB_URL_WITH_ZSTD
+    return std::make_unique<ZstdCompressor>( level );
+#else
+    break;
+#endif
+  }
+  return {};
+}
+
+// static
+bool Compressor::shouldCompress( const http::Request::Compression& compression
+                               , std::optional<size_t> numBytes )
+{
+  if ( !http::Request::Compression::isSupported( compression.encoding )
+    || ( compression.encoding == Encoding::eNone ) )
+  {
+    return false;
+  }
+  return !numBytes || ( *numBytes >= compression.minNumBytes );
+}
+
+Compressor::~Compressor() = default;
+
+void Compressor::setSource( Source s )
+{
+  source = std::move( s );
+}
+
+size_t Compressor::read( char* buffer, size_t numBytes )
+{
+  if ( finished )
+  {
+    return 0;
+  }
+
+  if ( input.empty() )
+  {
+    input.resize( inputNumBytesMax );
+  }
+
+  size_t numProduced{ 0 };
+  while ( numProduced < numBytes )
+  {
+    Flush flush{ sourceFinished ? Flush::eFinish : Flush::eNone };
+
+    if ( ( inputOffset == inputNumBytes ) && !sourceFinished )
+    {
+      const size_t numRead{ source( input.data(), input.size() ) };
+      if ( numRead == CURL_READFUNC_ABORT )
+      {
+        return CURL_READFUNC_ABORT;
+      }
+      else if ( numRead == CURL_READFUNC_PAUSE )
+      {
+        if ( !unflushed )
+        {
+          break;
+        }
+        // Send what we have rather than wait for the source.
+        flush = Flush::eSync;
+      }
+      else if ( numRead == 0 )
+      {
+        sourceFinished = true;
+        flush = Flush::eFinish;
+      }
+      else
+      {
+        inputOffset = 0;
+        inputNumBytes = numRead;
+        numIn += numRead;
+      }
+    }
+
+    const Result result{ compress( input.data() + inputOffset, inputNumBytes - inputOffset
+                                 , buffer + numProduced, numBytes - numProduced
+                                 , flush ) };
+    if ( !result.ok )
+    {
+      return CURL_READFUNC_ABORT;
+    }
+
+    inputOffset += result.numConsumed;
+    numProduced += result.numProduced;
+    unflushed = unflushed || ( result.numConsumed > 0 );
+
+    if ( ( flush == Flush::eFinish ) && result.done )
+    {
+      finished = true;
+      break;
+    }
+    if ( flush == Flush::eSync )
+    {
+      unflushed = !result.done;
+      break;
+    }
+  }
+
+  numOut += numProduced;
+
+  if ( ( numProduced == 0 ) && !finished )
+  {
+    return CURL_READFUNC_PAUSE;
+  }
+  return numProduced;
+}
+
+bool Compressor::reset()
+{
+  inputOffset = 0;
+  inputNumBytes = 0;
+  sourceFinished = false;
+  finished = false;
+  unflushed = false;
+  return restart();
+}
+
+size_t Compressor::numInBytes() const
+{
+  return numIn;
+}
+
+size_t Compressor::numOutBytes() const
+{
+  return numOut;
+}
+
+// static
+size_t Compressor::dataRead( char* buffer, size_t size, size_t nitems, void* userData )
+{
+  return ((Compressor*)(userData))->read( buffer, size * nitems );
+}
+
+
+} // End of namespace url
+
+
+} // End of namespace lb
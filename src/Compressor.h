@@ -0,0 +1,129 @@
+#ifndef LIB_LB_URL_COMPRESSOR_H
+#define LIB_LB_URL_COMPRESSOR_H
+
+/*
+    Copyright (C) 2023  Paul Fotheringham (LinuxBrickie)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// Private header
+
+#include <lb/url/http/Request.h>
+
+#include <functional>
+#include <memory>
+#include <optional>
+#include <vector>
+
+
+namespace lb
+{
+
+
+namespace url
+{
+
+
+/** \brief Compresses data on the fly in a libcurl read callback.
+
+    Data is pulled from a source with the same semantics as a libcurl read
+    callback, compressed and written straight into libcurl's buffer. If the
+    source pauses then whatever has been compressed so far is flushed so that
+    a slow producer is not held up waiting for more data to compress.
+ */
+class Compressor
+{
+public:
+  using Encoding = http::Request::Compression::Encoding;
+
+  /** \brief Returns null for eNone or an encoding that is not supported. */
+  static std::unique_ptr<Compressor> create( Encoding, int level );
+
+  /** \brief Whether a body of \a numBytes should be compressed.
+
+      \a numBytes is nothing if the size is not known up front.
+   */
+  static bool shouldCompress( const http::Request::Compression&, std::optional<size_t> numBytes );
+
+  virtual ~Compressor();
+
+  /** \brief The value for the Content-Encoding header. */
+  virtual const char* name() const = 0;
+
+  /** \brief Where uncompressed data is read from. Returns as per a libcurl
+             read callback, i.e. the number of bytes, zero at the end,
+             CURL_READFUNC_PAUSE or CURL_READFUNC_ABORT.
+   */
+  using Source = std::function< size_t( char* buffer, size_t numBytes ) >;
+  void setSource( Source );
+
+  /** \brief Fill \a buffer with compressed data. Returns as per \a Source. */
+  size_t read( char* buffer, size_t numBytes );
+
+  /** \brief Start again from scratch. The source must be rewound separately. */
+  bool reset();
+
+  /** \brief Running totals, including any data sent again after a reset. */
+  size_t numInBytes() const;
+  size_t numOutBytes() const;
+
+  // C-style callback used by libcurl. The void* is the address of the Compressor.
+  static size_t dataRead( char* buffer, size_t size, size_t nitems, void* userData );
+
+protected:
+  enum class Flush
+  {
+    eNone,
+    eSync,   //!< Output everything compressed so far.
+    eFinish  //!< End of the input.
+  };
+
+  struct Result
+  {
+    bool ok{ false };
+    size_t numConsumed{ 0 };
+    size_t numProduced{ 0 };
+    bool done{ false };      //!< The flush, or finish, is complete.
+  };
+
+  virtual Result compress( const char* in, size_t inNumBytes
+                         , char* out, size_t outNumBytes
+                         , Flush ) = 0;
+
+  virtual bool restart() = 0;
+
+private:
+  Source source;
+
+  std::vector<char> input;
+  size_t inputOffset{ 0 };
+  size_t inputNumBytes{ 0 };
+
+  bool sourceFinished{ false };
+  bool finished{ false };
+  bool unflushed{ false }; //!< Input has been compressed since the last flush.
+
+  size_t numIn{ 0 };
+  size_t numOut{ 0 };
+};
+
+
+} // End of namespace url
+
+
+} // End of namespace lb
+
+
+#endif // LIB_LB_URL_COMPRESSOR_H
@@ -0,0 +1,94 @@
+/*
+    Copyright (C) 2023  Paul Fotheringham (LinuxBrickie)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <lb/url/ConnectionTuning.h>
+
+
+namespace lb
+{
+
+
+namespace url
+{
+
+
+template<typename T>
+static void mergeSetting( std::optional<T>& setting, const std::optional<T>& override )
+{
+  if ( override )
+  {
+    setting = override;
+  }
+}
+
+
+ConnectionTuning& ConnectionTuning::merge( const ConnectionTuning& overrides )
+{
+  mergeSetting( tcpNoDelay, overrides.tcpNoDelay );
+  mergeSetting( tcpKeepAlive, overrides.tcpKeepAlive );
+  mergeSetting( tcpKeepIdleSeconds, overrides.tcpKeepIdleSeconds );
+  mergeSetting( tcpKeepIntervalSeconds, overrides.tcpKeepIntervalSeconds );
+  mergeSetting( receiveBufferSize, overrides.receiveBufferSize );
+  mergeSetting( uploadBufferSize, overrides.uploadBufferSize );
+  mergeSetting( tcpFastOpen, overrides.tcpFastOpen );
+  mergeSetting( maxConnectionAgeSeconds, overrides.maxConnectionAgeSeconds );
+
+  return *this;
+}
+
+// static
+ConnectionTuning ConnectionTuning::lowLatency()
+{
+  ConnectionTuning tuning;
+  tuning.tcpNoDelay = true;
+  // Keep pooled connections alive so that requests rarely pay for a handshake.
+  tuning.tcpKeepAlive = true;
+  tuning.tcpKeepIdleSeconds = 30;
+  tuning.tcpKeepIntervalSeconds = 10;
+  tuning.receiveBufferSize = 16 * 1024;
+  tuning.uploadBufferSize = 16 * 1024;
+  tuning.tcpFastOpen = true;
+  tuning.maxConnectionAgeSeconds = 300;
+  return tuning;
+}
+
+// static
+ConnectionTuning ConnectionTuning::bulk()
+{
+  ConnectionTuning tuning;
+  tuning.tcpNoDelay = false;
+  tuning.tcpKeepAlive = true;
+  tuning.tcpKeepIdleSeconds = 60;
+  tuning.tcpKeepIntervalSeconds = 30;
+  tuning.receiveBufferSize = 512 * 1024;
+  tuning.uploadBufferSize = 2 * 1024 * 1024;
+  tuning.tcpFastOpen = false;
+  tuning.maxConnectionAgeSeconds = 118; // The libcurl default
+  return tuning;
+}
+
+// static
+std::map<std::string, ConnectionTuning> ConnectionTuning::defaultProfiles()
+{
+  return { { "lowLatency", lowLatency() }, { "bulk", bulk() } };
+}
+
+
+} // End of namespace url
+
+
+} // End of namespace lb
@@ -0,0 +1,158 @@
+/*
+    Copyright (C) 2023  Paul Fotheringham (LinuxBrickie)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "FileRegion.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+namespace lb
+{
+
+
+namespace url
+{
+
+
+/** \brief Close \a fd and throw, for use before the destructor would. */
+[[noreturn]] static void closeAndThrow( int fd, const std::string& what )
+{
+  ::close( fd );
+  throw std::runtime_error( what );
+}
+
+
+FileRegion::FileRegion( const mime::MimePart::File& file )
+{
+  fd = ( file.fd >= 0 ) ? fcntl( file.fd, F_DUPFD_CLOEXEC, 0 )
+                        : ::open( file.path.c_str(), O_RDONLY | O_CLOEXEC );
+  if ( fd < 0 )
+  {
+    throw std::runtime_error( "Failed to open file: " + std::string( std::strerror( errno ) ) );
+  }
+
+  struct stat status;
+  if ( fstat( fd, &status ) != 0 )
+  {
+    closeAndThrow( fd, "Failed to stat file: " + std::string( std::strerror( errno ) ) );
+  }
+
+  const size_t fileNumBytes{ size_t( status.st_size ) };
+  if ( ( file.offset > fileNumBytes )
+    || ( file.numBytes > fileNumBytes - file.offset ) )
+  {
+    closeAndThrow( fd, "File region is beyond the end of the file." );
+  }
+
+  fileOffset = file.offset;
+  numBytes = ( file.numBytes > 0 ) ? file.numBytes : fileNumBytes - file.offset;
+
+  if ( !file.memoryMap || ( numBytes == 0 ) )
+  {
+    posix_fadvise( fd, off_t( fileOffset ), off_t( numBytes ), POSIX_FADV_SEQUENTIAL );
+    return;
+  }
+
+  // The mapping has to start on a page boundary.
+  const size_t pageSize{ size_t( sysconf( _SC_PAGESIZE ) ) };
+  const size_t mappingOffset{ fileOffset - fileOffset % pageSize };
+  mappingNumBytes = numBytes + ( fileOffset - mappingOffset );
+
+  void*const m{ mmap( nullptr, mappingNumBytes, PROT_READ, MAP_SHARED, fd, off_t( mappingOffset ) ) };
+  if ( m == MAP_FAILED )
+  {
+    closeAndThrow( fd, "Failed to map file: " + std::string( std::strerror( errno ) ) );
+  }
+  mapping = m;
+  madvise( mapping, mappingNumBytes, MADV_SEQUENTIAL );
+
+  data = std::string_view{ (const char*)mapping + ( fileOffset - mappingOffset ), numBytes };
+}
+
+FileRegion::~FileRegion()
+{
+  if ( mapping )
+  {
+    munmap( mapping, mappingNumBytes );
+  }
+  ::close( fd );
+}
+
+size_t FileRegion::read( char* buffer, size_t n )
+{
+  n = std::min( n, numBytes - offset );
+  if ( n == 0 )
+  {
+    return 0;
+  }
+
+  if ( mapping )
+  {
+    std::memcpy( buffer, data.data() + offset, n );
+    offset += n;
+    return n;
+  }
+
+  ssize_t numRead;
+  do
+  {
+    numRead = pread( fd, buffer, n, off_t( fileOffset + offset ) );
+  } while ( ( numRead < 0 ) && ( errno == EINTR ) );
+
+  // The file must have been truncated underneath us if nothing was read.
+  if ( numRead <= 0 )
+  {
+    return CURL_READFUNC_ABORT;
+  }
+  offset += size_t( numRead );
+  return size_t( numRead );
+}
+
+// static
+size_t FileRegion::dataRead( char* buffer, size_t size, size_t nitems, void* userData )
+{
+  return ((FileRegion*)(userData))->read( buffer, size * nitems );
+}
+
+// static
+int FileRegion::dataSeek( void* userData, curl_off_t offset, int origin )
+{
+  FileRegion& region{ *((FileRegion*)(userData)) };
+
+  if ( ( origin != SEEK_SET ) || ( offset < 0 ) || ( size_t( offset ) > region.numBytes ) )
+  {
+    return CURL_SEEKFUNC_CANTSEEK;
+  }
+
+  region.offset = size_t( offset );
+  return CURL_SEEKFUNC_OK;
+}
+
+
+} // End of namespace url
+
+
+} // End of namespace lb
@@ -0,0 +1,83 @@
+#ifndef LIB_LB_URL_FILEREGION_H
+#define LIB_LB_URL_FILEREGION_H
+
+/*
+    Copyright (C) 2023  Paul Fotheringham (LinuxBrickie)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// Private header
+
+#include <lb/url/mime/MimePart.h>
+
+#include <curl/curl.h>
+
+#include <string_view>
+
+
+namespace lb
+{
+
+
+namespace url
+{
+
+
+/** \brief A region of a file read lazily for libcurl, \sa mime::MimePart::File.
+
+    Used for both http::Body::file and MIME part files. The file is opened, or
+    its descriptor duplicated, on construction and closed on destruction.
+ */
+struct FileRegion
+{
+  /** \brief Throws std::runtime_error if the file cannot be opened or mapped
+             or the region does not lie within it.
+   */
+  explicit FileRegion( const mime::MimePart::File& );
+  ~FileRegion();
+
+  FileRegion( const FileRegion& ) = delete;
+  FileRegion& operator=( const FileRegion& ) = delete;
+
+  /** \brief Copy up to \a numBytes from the current position to \a buffer.
+      \return The number of bytes copied, zero at the end of the region or
+              CURL_READFUNC_ABORT if the file has been truncated.
+   */
+  size_t read( char* buffer, size_t numBytes );
+
+  // C-style callbacks used by libcurl. The void* is the address of the FileRegion.
+  static size_t dataRead( char *buffer, size_t size, size_t nitems, void* userData );
+  static int dataSeek( void* userData, curl_off_t offset, int origin );
+
+  size_t numBytes{ 0 }; //!< The size of the region.
+  size_t offset{ 0 };   //!< Next byte of the region to be read.
+
+private:
+  int fd{ -1 };           //!< Owned duplicate of, or opened from, File::fd or File::path.
+  size_t fileOffset{ 0 }; //!< Where the region starts in the file.
+
+  void* mapping{ nullptr };    //!< Page aligned so may start before \a data.
+  size_t mappingNumBytes{ 0 };
+  std::string_view data;       //!< The region within \a mapping, if mapped.
+};
+
+
+} // End of namespace url
+
+
+} // End of namespace lb
+
+
+#endif // LIB_LB_URL_FILEREGION_H
@@ -0,0 +1,234 @@
+/*
+    Copyright (C) 2023  Paul Fotheringham (LinuxBrickie)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "HostLimiter.h"
+
+#include <algorithm>
+
+
+namespace lb
+{
+
+
+namespace url
+{
+
+
+HostSlot::HostSlot( HostLimiter& l, std::string k )
+  : limiter{ l }
+  , key{ std::move( k ) }
+{
+}
+
+HostSlot::~HostSlot()
+{
+  --limiter.state( key ).numInFlight;
+}
+
+HostLimiter::HostLimiter( HostLimits d, std::map<std::string, HostLimits> l )
+  : defaultLimits{ std::move( d ) }
+  , limits{ std::move( l ) }
+{
+}
+
+bool HostLimiter::canAdmit( const std::string& key )
+{
+  if ( key.empty() )
+  {
+    return true;
+  }
+
+  State& s{ state( key ) };
+
+  if ( ( s.limits.maxConcurrentRequests > 0 )
+    && ( s.numInFlight >= s.limits.maxConcurrentRequests ) )
+  {
+    return false;
+  }
+
+  if ( s.limits.requestsPerSecond > 0.0 )
+  {
+    refill( s );
+    if ( s.numTokens < 1.0 )
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+std::unique_ptr<HostSlot> HostLimiter::admit( const std::string& key )
+{
+  if ( key.empty() )
+  {
+    return {};
+  }
+
+  State& s{ state( key ) };
+  ++s.numInFlight;
+  if ( s.limits.requestsPerSecond > 0.0 )
+  {
+    s.numTokens -= 1.0;
+  }
+
+  return std::make_unique<HostSlot>( *this, key );
+}
+
+bool HostLimiter::takeToken( const std::string& key )
+{
+  if ( key.empty() )
+  {
+    return true;
+  }
+
+  State& s{ state( key ) };
+  if ( s.limits.requestsPerSecond <= 0.0 )
+  {
+    return true;
+  }
+
+  refill( s );
+  if ( s.numTokens < 1.0 )
+  {
+    return false;
+  }
+
+  s.numTokens -= 1.0;
+  return true;
+}
+
+HostLimiter::Clock::time_point HostLimiter::tokenDue( const std::string& key )
+{
+  const auto now{ Clock::now() };
+  if ( key.empty() )
+  {
+    return now;
+  }
+
+  State& s{ state( key ) };
+  if ( s.limits.requestsPerSecond <= 0.0 )
+  {
+    return now;
+  }
+
+  refill( s );
+  if ( s.numTokens >= 1.0 )
+  {
+    return now;
+  }
+
+  // Rounded up so that the token really is available by then.
+  const std::chrono::duration<double> untilToken{ ( 1.0 - s.numTokens ) / s.limits.requestsPerSecond };
+  return now + std::chrono::ceil<Clock::duration>( untilToken );
+}
+
+std::optional<HostLimiter::Clock::time_point> HostLimiter::nextTokenDue() const
+{
+  std::optional<Clock::time_point> due;
+
+  const auto now{ Clock::now() };
+  for ( const auto&[key, s] : states )
+  {
+    if ( s.limits.requestsPerSecond <= 0.0 )
+    {
+      continue;
+    }
+
+    // Work out the number of tokens as of now without refilling.
+    const std::chrono::duration<double> elapsed{ now - s.lastRefilled };
+    const double numTokens{ s.numTokens + elapsed.count() * s.limits.requestsPerSecond };
+    if ( numTokens < 1.0 )
+    {
+      const std::chrono::duration<double> untilToken{ ( 1.0 - numTokens ) / s.limits.requestsPerSecond };
+      const auto tokenDue{ now + std::chrono::duration_cast<Clock::duration>( untilToken ) };
+      if ( !due || ( tokenDue < *due ) )
+      {
+        due = tokenDue;
+      }
+    }
+  }
+
+  return due;
+}
+
+HostLimiter::State& HostLimiter::state( const std::string& key )
+{
+  auto S{ states.find( key ) };
+  if ( S == states.end() )
+  {
+    if ( states.size() >= pruneSize )
+    {
+      prune();
+    }
+
+    const auto L{ limits.find( key ) };
+    const HostLimits& l{ ( L != limits.end() ) ? L->second : defaultLimits };
+    S = states.emplace( key, State{ l, 0, double( std::max( l.burst, size_t( 1 ) ) ), Clock::now() } ).first;
+  }
+  return S->second;
+}
+
+void HostLimiter::refill( State& s )
+{
+  const auto now{ Clock::now() };
+  const std::chrono::duration<double> elapsed{ now - s.lastRefilled };
+  s.lastRefilled = now;
+
+  s.numTokens = std::min( s.numTokens + elapsed.count() * s.limits.requestsPerSecond
+                        , double( std::max( s.limits.burst, size_t( 1 ) ) ) );
+}
+
+bool HostLimiter::isIdle( State& s )
+{
+  if ( s.numInFlight > 0 )
+  {
+    return false;
+  }
+
+  if ( s.limits.requestsPerSecond <= 0.0 )
+  {
+    return true;
+  }
+
+  refill( s );
+  return s.numTokens >= double( std::max( s.limits.burst, size_t( 1 ) ) );
+}
+
+void HostLimiter::prune()
+{
+  for ( auto S = states.begin(); S != states.end(); )
+  {
+    if ( isIdle( S->second ) )
+    {
+      S = states.erase( S );
+    }
+    else
+    {
+      ++S;
+    }
+  }
+
+  // Amortise the cost of pruning over the keys added before the next prune.
+  pruneSize = std::max( minPruneSize, 2 * states.size() );
+}
+
+
+} // End of namespace url
+
+
+} // End of namespace lb
@@ -0,0 +1,134 @@
+#ifndef LIB_LB_URL_HOSTLIMITER_H
+#define LIB_LB_URL_HOSTLIMITER_H
+
+/*
+    Copyright (C) 2023  Paul Fotheringham (LinuxBrickie)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// Private header
+
+#include <lb/url/Requester.h>
+
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+
+namespace lb
+{
+
+
+namespace url
+{
+
+
+class HostLimiter;
+
+
+/** \brief Releases the concurrency held by an admitted request on destruction. */
+class HostSlot
+{
+public:
+  HostSlot( HostLimiter&, std::string key );
+  ~HostSlot();
+
+  HostSlot( const HostSlot& ) = delete;
+  HostSlot& operator=( const HostSlot& ) = delete;
+
+private:
+  HostLimiter& limiter;
+  const std::string key;
+};
+
+
+/** \brief Enforces Requester::Config::HostLimits for each host or key.
+
+    Each key has a count of requests in flight and a token bucket. A request
+    holds a HostSlot from admission until its handler is destroyed. Retries
+    keep their slot but must take a fresh token.
+
+    Keys with nothing in flight and a full bucket are indistinguishable from
+    new keys so are forgotten from time to time to bound the memory used.
+
+    Only ever used on the Requester thread so there is no locking.
+ */
+class HostLimiter
+{
+public:
+  using Clock = std::chrono::steady_clock;
+  using HostLimits = Requester::Config::HostLimits;
+
+  HostLimiter( HostLimits defaultLimits, std::map<std::string, HostLimits> limits );
+
+  /** \brief Whether a request for \a key can be admitted right now. An empty
+             key is never limited.
+   */
+  bool canAdmit( const std::string& key );
+
+  /** \brief Take a token and a concurrency slot for \a key.
+
+      Only call if \a canAdmit returned true.
+   */
+  std::unique_ptr<HostSlot> admit( const std::string& key );
+
+  /** \brief Take a token for \a key, without a concurrency slot, e.g. for a
+             retry that still holds its slot.
+      \return False if there is no token available, \sa tokenDue.
+   */
+  bool takeToken( const std::string& key );
+
+  /** \brief When a token next becomes available for \a key. */
+  Clock::time_point tokenDue( const std::string& key );
+
+  /** \brief When the next token becomes available for a key that has none. */
+  std::optional<Clock::time_point> nextTokenDue() const;
+
+private:
+  friend class HostSlot;
+
+  struct State
+  {
+    HostLimits limits;
+    size_t numInFlight{ 0 };
+    double numTokens;
+    Clock::time_point lastRefilled;
+  };
+
+  State& state( const std::string& key );
+  void refill( State& );
+  bool isIdle( State& );
+  void prune();
+
+  const HostLimits defaultLimits;
+  const std::map<std::string, HostLimits> limits;
+
+  std::unordered_map<std::string, State> states;
+
+  //! \a states is pruned when a new key would take it to this size.
+  size_t pruneSize{ minPruneSize };
+  static constexpr size_t minPruneSize{ 64 };
+};
+
+
+} // End of namespace url
+
+
+} // End of namespace lb
+
+
+#endif // LIB_LB_URL_HOSTLIMITER_H
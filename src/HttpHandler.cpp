@@ -17,6 +17,13 @@
 
 #include "HttpHandler.h"
 
+#include "LatencyTracker.h"
+#include "http/PreparedRequestImpl.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
 
 namespace lb
 {
@@ -26,12 +33,46 @@ namespace url
 {
 
 
+/** \brief The body to be sent by UploadHelper.
+
+    This is normally just Request::body but URL encoded values are also sent
+    via UploadHelper if they are to be compressed.
+ */
+static http::Body uploadBody( http::Request& request )
+{
+  if ( ( request.method == http::Request::Method::ePost )
+    && !request.postUrlEncodedValues.empty()
+    && Compressor::shouldCompress( request.compression, request.postUrlEncodedValues.size() ) )
+  {
+    http::Body body;
+    body.data = std::move( request.postUrlEncodedValues );
+    request.postUrlEncodedValues.clear();
+    return body;
+  }
+
+  return std::move( request.body );
+}
+
+
 HttpHandler::HttpHandler( http::Request r, http::Response::Callback c )
   : request{ std::move( r ) }
   , responseCallback{ std::move( c ) }
-  , mimeHelper{ std::move( request.mimePost ) }
+  , mimeHelper{ std::move( request.mimePost ), request.compression }
+  , uploadHelper{ uploadBody( request ), request.compression }
 {
-  curl_easy_setopt( easyHandle, CURLOPT_URL, request.url.c_str() );
+  const http::PreparedRequest::Impl* prepared{ http::PreparedRequest::Impl::get( request.prepared.from ) };
+
+  if ( prepared && request.url.empty() && ( preparedUrl = prepared->url( request.prepared ) ) )
+  {
+    // Note that curl_easy_setopt will NOT copy the handle
+    curl_easy_setopt( easyHandle, CURLOPT_CURLU, preparedUrl );
+  }
+  else
+  {
+    curl_easy_setopt( easyHandle, CURLOPT_URL, request.url.c_str() );
+  }
+
+  tune( request.tuning );
 
   switch( request.method )
   {
@@ -46,60 +87,282 @@ HttpHandler::HttpHandler( http::Request r, http::Response::Callback c )
     {
       curl_easy_setopt( easyHandle, CURLOPT_POSTFIELDS, request.postUrlEncodedValues.c_str() );
     }
+    else if ( mimeHelper.mime.parts.empty() && !uploadHelper.body.empty() )
+    {
+      uploadHelper.setOptions( easyHandle, true );
+    }
     else // assume MIME for now
     {
       mimeHelper.setOptions( easyHandle );
     }
     break;
   case http::Request::Method::ePut:
-    curl_easy_setopt( easyHandle, CURLOPT_UPLOAD, 1L );
+    uploadHelper.setOptions( easyHandle, false );
     break;
   case http::Request::Method::eDelete:
     curl_easy_setopt( easyHandle, CURLOPT_CUSTOMREQUEST, "DELETE" );
     break;
   }
 
+  // Only has an effect for HTTP/2. The default weight is 16.
+  switch( request.priority )
+  {
+  case Priority::eLow:
+    curl_easy_setopt( easyHandle, CURLOPT_STREAM_WEIGHT, 4L );
+    break;
+  case Priority::eNormal:
+    curl_easy_setopt( easyHandle, CURLOPT_STREAM_WEIGHT, 16L );
+    break;
+  case Priority::eHigh:
+    curl_easy_setopt( easyHandle, CURLOPT_STREAM_WEIGHT, 64L );
+    break;
+  case Priority::eCritical:
+    curl_easy_setopt( easyHandle, CURLOPT_STREAM_WEIGHT, 256L );
+    break;
+  }
+
   headerList = nullptr;
   for ( const auto& header : request.headers )
   {
     // Note that curl_slist_append copies the string.
     headerList = curl_slist_append( headerList, header.c_str() );
   }
+  if ( uploadHelper.compressor )
+  {
+    const std::string header{ std::string( "Content-Encoding: " ) + uploadHelper.compressor->name() };
+    headerList = curl_slist_append( headerList, header.c_str() );
+  }
+  if ( prepared && prepared->headerList )
+  {
+    if ( headerList )
+    {
+      // Link to the prepared headers rather than copying them.
+      for ( headerListTail = headerList; headerListTail->next; headerListTail = headerListTail->next );
+      headerListTail->next = prepared->headerList;
+    }
+    else
+    {
+      // Only read by libcurl so it can be shared.
+      headerList = prepared->headerList;
+    }
+  }
   // Note that curl_easy_setopt will NOT copy the list
   curl_easy_setopt( easyHandle, CURLOPT_HTTPHEADER, headerList );
 }
 
 HttpHandler::~HttpHandler()
 {
-  curl_slist_free_all( headerList );
+  const http::PreparedRequest::Impl* prepared{ http::PreparedRequest::Impl::get( request.prepared.from ) };
+  if ( headerListTail )
+  {
+    headerListTail->next = nullptr;
+  }
+  if ( !prepared || ( headerList != prepared->headerList ) )
+  {
+    curl_slist_free_all( headerList );
+  }
+  curl_url_cleanup( preparedUrl );
 }
 
 RequestHandler::Status HttpHandler::respond( ResponseCode rc, std::string receivedData )
 {
   long httpResponseCode;
   const CURLcode cc{ curl_easy_getinfo( easyHandle, CURLINFO_RESPONSE_CODE, &httpResponseCode ) };
+  http::Response response;
+  response.numAttempts = numAttempts;
+  response.queueWaitMicroseconds = std::chrono::duration_cast<std::chrono::microseconds>( queueWait ).count();
+  response.uncompressedBodyNumBytes = mimeHelper.numUncompressedBytes();
+  response.compressedBodyNumBytes = mimeHelper.numCompressedBytes();
+  if ( uploadHelper.compressor )
+  {
+    response.uncompressedBodyNumBytes += uploadHelper.compressor->numInBytes();
+    response.compressedBodyNumBytes += uploadHelper.compressor->numOutBytes();
+  }
+
+  if ( rc != ResponseCode::eSuccess )
+  {
+    // The transfer did not complete, e.g. it was aborted, so any response
+    // code is meaningless.
+    responseCallback( rc, std::move( response ) );
+    return Status::eFinished;
+  }
+
   switch( cc )
   {
   case CURLE_OK:
     if ( httpResponseCode == 0 ) // server did not send a valid code
     {
-      responseCallback( ResponseCode::eFailure, {} );
+      responseCallback( ResponseCode::eFailure, std::move( response ) );
     }
     else
     {
-      responseCallback( rc
-                      , { (unsigned int)httpResponseCode
-                        , std::move( receivedData ) } );
+      response.code = (unsigned int)httpResponseCode;
+      response.content = std::move( receivedData );
+      responseCallback( rc, std::move( response ) );
     }
     break;
   default:
-    responseCallback( ResponseCode::eFailure, {} );
+    responseCallback( ResponseCode::eFailure, std::move( response ) );
     break;
   }
 
   return Status::eFinished;
 }
 
+std::optional<std::chrono::milliseconds> HttpHandler::retryDelay( CURLcode result )
+{
+  const http::Request::RetryPolicy& policy{ request.retryPolicy };
+  if ( ( numAttempts >= policy.maxAttempts ) || request.bodySink || !uploadHelper.canRewind() )
+  {
+    return std::nullopt;
+  }
+
+  bool retryable{ false };
+  if ( result == CURLE_OK )
+  {
+    long httpResponseCode;
+    if ( curl_easy_getinfo( easyHandle, CURLINFO_RESPONSE_CODE, &httpResponseCode ) == CURLE_OK )
+    {
+      const auto& codes{ policy.retryableStatusCodes };
+      retryable = std::find( codes.begin(), codes.end(), (unsigned int)httpResponseCode ) != codes.end();
+    }
+  }
+  else
+  {
+    const auto& codes{ policy.retryableCurlCodes };
+    retryable = std::find( codes.begin(), codes.end(), (int)result ) != codes.end();
+  }
+
+  if ( !retryable )
+  {
+    return std::nullopt;
+  }
+
+  const double backoff
+  {
+    std::min( policy.initialBackoffMilliseconds * std::pow( policy.backoffMultiplier, numAttempts - 1 )
+            , double( policy.maxBackoffMilliseconds ) )
+  };
+
+  static thread_local std::minstd_rand generator{ std::random_device{}() };
+  const double jitter{ std::clamp( policy.jitter, 0.0, 1.0 ) };
+  std::uniform_real_distribution<double> distribution{ 1.0 - jitter, 1.0 };
+
+  return std::chrono::milliseconds{ (long long)( backoff * distribution( generator ) ) };
+}
+
+void HttpHandler::restart()
+{
+  RequestHandler::restart();
+  uploadHelper.rewind();
+  ++numAttempts;
+}
+
+std::optional<std::chrono::milliseconds> HttpHandler::hedgeDelay( LatencyTracker& latencies ) const
+{
+  if ( request.bodySink )
+  {
+    return std::nullopt;
+  }
+
+  switch( request.method )
+  {
+  case http::Request::Method::eGet:
+  case http::Request::Method::eHead:
+    break;
+  default:
+    return std::nullopt;
+  }
+
+  const http::Request::HedgePolicy& policy{ request.hedgePolicy };
+  if ( policy.delayPercentile > 0.0 )
+  {
+    if ( const auto delay{ latencies.percentile( policy.delayPercentile ) } )
+    {
+      return delay;
+    }
+  }
+
+  if ( policy.delayMilliseconds > 0 )
+  {
+    return std::chrono::milliseconds{ policy.delayMilliseconds };
+  }
+
+  return std::nullopt;
+}
+
+Priority HttpHandler::priority() const
+{
+  return request.priority;
+}
+
+std::string HttpHandler::limitKey() const
+{
+  if ( !request.rateLimitKey.empty() )
+  {
+    return request.rateLimitKey;
+  }
+
+  if ( preparedUrl )
+  {
+    return http::PreparedRequest::Impl::get( request.prepared.from )->host;
+  }
+
+  std::string host;
+  if ( CURLU* url{ curl_url() } )
+  {
+    char* part{ nullptr };
+    if ( ( curl_url_set( url, CURLUPART_URL, request.url.c_str(), CURLU_DEFAULT_SCHEME ) == CURLUE_OK )
+      && ( curl_url_get( url, CURLUPART_HOST, &part, 0 ) == CURLUE_OK ) )
+    {
+      host = part;
+      curl_free( part );
+    }
+    curl_url_cleanup( url );
+  }
+  return host;
+}
+
+void HttpHandler::bind( RequestHandle handle )
+{
+  uploadHelper.bind( std::move( handle ) );
+}
+
+size_t HttpHandler::processReceivedData( const char* data, size_t numBytes )
+{
+  if ( !request.bodySink )
+  {
+    return RequestHandler::processReceivedData( data, numBytes );
+  }
+
+  switch( request.bodySink( { data, numBytes } ) )
+  {
+  case http::Request::SinkStatus::eContinue:
+    break;
+  case http::Request::SinkStatus::ePause:
+    return CURL_WRITEFUNC_PAUSE;
+  }
+  return numBytes;
+}
+
+std::unique_ptr<RequestHandler> HttpHandler::createHedge()
+{
+  // Share the callback between the two handlers. Requester guarantees that
+  // only one of them will ever respond.
+  const auto callback{ std::make_shared<http::Response::Callback>( std::move( responseCallback ) ) };
+
+  responseCallback = [callback]( ResponseCode rc, http::Response r )
+  {
+    (*callback)( rc, std::move( r ) );
+  };
+
+  return std::make_unique<HttpHandler>( request
+                                      , [callback]( ResponseCode rc, http::Response r )
+                                        {
+                                          (*callback)( rc, std::move( r ) );
+                                        } );
+}
+
 
 } // End of namespace url
 
@@ -25,6 +25,7 @@
 
 #include "RequestHandler.h"
 #include "MimeHelper.h"
+#include "UploadHelper.h"
 
 
 namespace lb
@@ -42,12 +43,39 @@ struct HttpHandler : public RequestHandler
 
   virtual Status respond( ResponseCode, std::string );
 
+  virtual std::optional<std::chrono::milliseconds> retryDelay( CURLcode );
+  virtual void restart();
+
+  virtual std::optional<std::chrono::milliseconds> hedgeDelay( LatencyTracker& ) const;
+  virtual std::unique_ptr<RequestHandler> createHedge();
+  virtual Priority priority() const;
+  virtual std::string limitKey() const;
+
+  virtual size_t processReceivedData( const char* data, size_t numBytes );
+
+  /** \brief Called by Requester with the handle returned to the request maker. */
+  void bind( RequestHandle );
+
   http::Request request;
   http::Response::Callback responseCallback;
 
   curl_slist* headerList{ nullptr };
 
+  /** \brief The last of our own headers when they are followed by the
+             prepared headers, \sa http::PreparedRequest.
+
+      The prepared headers are shared so are unlinked before headerList is
+      freed.
+   */
+  curl_slist* headerListTail{ nullptr };
+
+  CURLU* preparedUrl{ nullptr };
+
   MimeHelper mimeHelper;
+
+  UploadHelper uploadHelper;
+
+  unsigned int numAttempts{ 1 };
 };
 
 
@@ -0,0 +1,108 @@
+/*
+    Copyright (C) 2023  Paul Fotheringham (LinuxBrickie)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "LatencyTracker.h"
+
+#include <algorithm>
+
+
+namespace lb
+{
+
+
+namespace url
+{
+
+
+// Fewer samples than this and percentiles are not meaningful.
+static const size_t minNumSamples{ 20 };
+
+// Sort the window again after this many new samples.
+static const size_t maxNumAddedSinceSorted{ 50 };
+
+
+LatencyTracker::LatencyTracker( size_t w )
+  : windowSize{ std::max( w, minNumSamples ) }
+{
+  samples.reserve( windowSize );
+}
+
+void LatencyTracker::add( std::chrono::microseconds latency )
+{
+  if ( samples.size() < windowSize )
+  {
+    samples.push_back( latency );
+  }
+  else
+  {
+    samples[ next ] = latency;
+    next = ( next + 1 ) % windowSize;
+  }
+
+  ++numAddedSinceSorted;
+}
+
+std::optional<std::chrono::milliseconds> LatencyTracker::percentile( double p )
+{
+  if ( samples.size() < minNumSamples )
+  {
+    return std::nullopt;
+  }
+
+  if ( sorted.empty() || ( numAddedSinceSorted > maxNumAddedSinceSorted ) )
+  {
+    sorted.assign( samples.begin(), samples.end() );
+    std::sort( sorted.begin(), sorted.end() );
+    numAddedSinceSorted = 0;
+  }
+
+  const size_t index
+  {
+    std::min( size_t( std::clamp( p, 0.0, 100.0 ) / 100.0 * sorted.size() ), sorted.size() - 1 )
+  };
+  return std::chrono::ceil<std::chrono::milliseconds>( sorted[ index ] );
+}
+
+HostLatencies::HostLatencies( size_t m )
+  : maxNumKeys{ std::max( m, size_t( 1 ) ) }
+{
+}
+
+LatencyTracker& HostLatencies::at( const std::string& key )
+{
+  auto E{ entries.find( key ) };
+  if ( E == entries.end() )
+  {
+    if ( entries.size() >= maxNumKeys )
+    {
+      entries.erase( std::min_element( entries.begin(), entries.end(), []( const auto& a, const auto& b )
+      {
+        return a.second.lastUsed < b.second.lastUsed;
+      } ) );
+    }
+    E = entries.emplace( key, Entry{} ).first;
+  }
+
+  E->second.lastUsed = ++numUses;
+  return E->second.tracker;
+}
+
+
+} // End of namespace url
+
+
+} // End of namespace lb
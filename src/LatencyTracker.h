@@ -0,0 +1,104 @@
+#ifndef LIB_LB_URL_LATENCYTRACKER_H
+#define LIB_LB_URL_LATENCYTRACKER_H
+
+/*
+    Copyright (C) 2023  Paul Fotheringham (LinuxBrickie)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// Private header
+
+#include <chrono>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+namespace lb
+{
+
+
+namespace url
+{
+
+
+/** \brief Tracks the latency of recently completed requests.
+
+    Keeps a fixed size window of the most recent samples. A sorted copy of the
+    window is made lazily and kept as percentiles are typically asked for far
+    more often than they change significantly. Any percentile can then be read
+    straight off it.
+
+    Only ever used on the Requester thread so there is no locking.
+ */
+class LatencyTracker
+{
+public:
+  LatencyTracker( size_t windowSize = 1000 );
+
+  void add( std::chrono::microseconds );
+
+  /** \brief The latency below which \a percentile percent of samples fall.
+      \return Nothing if there are not yet enough samples to be meaningful.
+   */
+  std::optional<std::chrono::milliseconds> percentile( double percentile );
+
+private:
+  std::vector<std::chrono::microseconds> samples;
+  size_t windowSize;
+  size_t next{ 0 };
+
+  std::vector<std::chrono::microseconds> sorted;
+  size_t numAddedSinceSorted{ 0 };
+};
+
+
+/** \brief A LatencyTracker for each host, or key, so that one slow host does
+           not set the hedge delay for every other host.
+
+    Holds at most \a maxNumKeys trackers. When a new key needs one the tracker
+    used least recently is dropped.
+
+    Only ever used on the Requester thread so there is no locking.
+ */
+class HostLatencies
+{
+public:
+  HostLatencies( size_t maxNumKeys = 256 );
+
+  /** \brief The tracker for \a key, created if need be. */
+  LatencyTracker& at( const std::string& key );
+
+private:
+  struct Entry
+  {
+    LatencyTracker tracker;
+    size_t lastUsed{ 0 };
+  };
+
+  std::unordered_map<std::string, Entry> entries;
+  size_t maxNumKeys;
+  size_t numUses{ 0 };
+};
+
+
+} // End of namespace url
+
+
+} // End of namespace lb
+
+
+#endif // LIB_LB_URL_LATENCYTRACKER_H
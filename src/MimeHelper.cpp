@@ -17,6 +17,9 @@
 
 #include "MimeHelper.h"
 
+#include <algorithm>
+#include <cstring>
+
 
 namespace lb
 {
@@ -26,13 +29,43 @@ namespace url
 {
 
 
+/** \brief The in-memory data of \a part, \sa mime::MimePart. */
+static std::string_view memoryData( const mime::MimePart& part )
+{
+  if ( part.sharedData )
+  {
+    return *part.sharedData;
+  }
+
+  if ( !part.dataView.empty() )
+  {
+    return part.dataView;
+  }
+
+  // Zero terminated data is sent without the terminator.
+  return ( !part.data.empty() && ( part.data.back() == '\0' ) ) ? std::string_view{ part.data.c_str() }
+                                                                : std::string_view{ part.data };
+}
+
+
 MimeHelper::MimeHelper()
 {
 }
 
-MimeHelper::MimeHelper( mime::Mime mp )
+MimeHelper::MimeHelper( mime::Mime mp, http::Request::Compression c )
   : mime{ std::move( mp ) }
+  , compression{ c }
 {
+  // Open the files now so that failures are reported to the request maker.
+  fileParts.resize( mime.parts.size() );
+  for ( size_t i = 0; i < mime.parts.size(); ++i )
+  {
+    const mime::MimePart& part{ mime.parts[ i ] };
+    if ( !part.dataReader.dataReadFn && ( ( part.file.fd >= 0 ) || !part.file.path.empty() ) )
+    {
+      fileParts[ i ] = std::make_unique<FileRegion>( part.file );
+    }
+  }
 }
 
 MimeHelper::~MimeHelper()
@@ -49,8 +82,13 @@ bool MimeHelper::setOptions( CURL* easyHandle )
 
   mimeParts = curl_mime_init( easyHandle );
 
-  for ( auto& part : mime.parts )
+  memoryParts.reserve( mime.parts.size() );
+
+  for ( size_t i = 0; i < mime.parts.size(); ++i )
   {
+    mime::MimePart& part{ mime.parts[ i ] };
+    FileRegion*const filePart{ fileParts[ i ].get() };
+
     curl_mimepart* p = curl_mime_addpart( mimeParts );
 
     if ( !part.type.empty() )
@@ -71,20 +109,65 @@ bool MimeHelper::setOptions( CURL* easyHandle )
 
     curl_mime_name( p, part.name.c_str() );
 
-    if ( part.dataReader.dataReadFn )
+    if ( filePart )
     {
-      curl_mime_data_cb( p, part.dataReader.totalNumBytes, &dataRead, &dataSeek, nullptr, &part.dataReader );
+      const std::string& fileName{ part.file.fileName.empty() ? part.file.path : part.file.fileName };
+      if ( !fileName.empty() )
+      {
+        curl_mime_filename( p, fileName.substr( fileName.find_last_of( '/' ) + 1 ).c_str() );
+      }
     }
-    else // data is set in the data string buffer, ready to be copied
+
+    const std::string_view data{ memoryData( part ) };
+
+    const size_t numBytes
+    {
+      part.dataReader.dataReadFn ? part.dataReader.totalNumBytes
+                                 : filePart ? filePart->numBytes : data.size()
+    };
+    if ( Compressor::shouldCompress( compression, numBytes ) )
     {
-      if ( !part.data.empty() && ( part.data.back() == '\0' ) )
+      auto compressedPart{ std::make_unique<CompressedPart>() };
+      compressedPart->compressor = Compressor::create( compression.encoding, compression.level );
+      if ( part.dataReader.dataReadFn )
+      {
+        compressedPart->dataReader = &part.dataReader;
+      }
+      else if ( filePart )
       {
-        curl_mime_data( p, part.data.c_str(), CURL_ZERO_TERMINATED );
+        compressedPart->file = filePart;
       }
       else
       {
-        curl_mime_data( p, part.data.c_str(), part.data.size() );
+        compressedPart->memory.data = data;
       }
+      compressedPart->compressor->setSource( [c = compressedPart.get()]( char* buffer, size_t n )
+      {
+        return c->read( buffer, n );
+      } );
+
+      // The compressed size is not known up front.
+      curl_mime_data_cb( p, -1, &CompressedPart::dataRead, &CompressedPart::dataSeek, nullptr, compressedPart.get() );
+
+      const std::string header{ std::string( "Content-Encoding: " ) + compressedPart->compressor->name() };
+      curl_mime_headers( p, curl_slist_append( nullptr, header.c_str() ), 1 );
+
+      compressedParts.push_back( std::move( compressedPart ) );
+    }
+    else if ( part.dataReader.dataReadFn )
+    {
+      curl_mime_data_cb( p, part.dataReader.totalNumBytes, &dataRead, &dataSeek, nullptr, &part.dataReader );
+    }
+    else if ( filePart )
+    {
+      curl_mime_data_cb( p, filePart->numBytes, &FileRegion::dataRead, &FileRegion::dataSeek, nullptr, filePart );
+    }
+    else
+    {
+      // Read from where it is rather than letting curl_mime_data copy it. The
+      // Mime, or the caller for a dataView, keeps it alive.
+      MemoryPart& memoryPart{ memoryParts.emplace_back( MemoryPart{ data } ) };
+      curl_mime_data_cb( p, data.size(), &MemoryPart::dataRead, &MemoryPart::dataSeek, nullptr, &memoryPart );
     }
   }
 
@@ -93,6 +176,121 @@ bool MimeHelper::setOptions( CURL* easyHandle )
   return true;
 }
 
+size_t MimeHelper::numUncompressedBytes() const
+{
+  size_t total{ 0 };
+  for ( const auto& compressedPart : compressedParts )
+  {
+    total += compressedPart->compressor->numInBytes();
+  }
+  return total;
+}
+
+size_t MimeHelper::numCompressedBytes() const
+{
+  size_t total{ 0 };
+  for ( const auto& compressedPart : compressedParts )
+  {
+    total += compressedPart->compressor->numOutBytes();
+  }
+  return total;
+}
+
+size_t MimeHelper::MemoryPart::read( char* buffer, size_t numBytes )
+{
+  numBytes = std::min( numBytes, data.size() - offset );
+  std::memcpy( buffer, data.data() + offset, numBytes );
+  offset += numBytes;
+  return numBytes;
+}
+
+// static
+size_t MimeHelper::MemoryPart::dataRead( char* buffer, size_t size, size_t nitems, void* userData )
+{
+  return ((MemoryPart*)(userData))->read( buffer, size * nitems );
+}
+
+// static
+int MimeHelper::MemoryPart::dataSeek( void* userData, curl_off_t offset, int origin )
+{
+  MemoryPart& part{ *((MemoryPart*)(userData)) };
+
+  curl_off_t base{ 0 };
+  switch ( origin )
+  {
+  case SEEK_SET:
+    break;
+  case SEEK_CUR:
+    base = curl_off_t( part.offset );
+    break;
+  case SEEK_END:
+    base = curl_off_t( part.data.size() );
+    break;
+  default:
+    return CURL_SEEKFUNC_FAIL;
+  }
+
+  if ( ( base + offset < 0 ) || ( base + offset > curl_off_t( part.data.size() ) ) )
+  {
+    return CURL_SEEKFUNC_FAIL;
+  }
+
+  part.offset = size_t( base + offset );
+  return CURL_SEEKFUNC_OK;
+}
+
+size_t MimeHelper::CompressedPart::read( char* buffer, size_t numBytes )
+{
+  if ( dataReader )
+  {
+    return dataReader->dataReadFn( buffer, numBytes );
+  }
+
+  if ( file )
+  {
+    return file->read( buffer, numBytes );
+  }
+
+  return memory.read( buffer, numBytes );
+}
+
+// static
+size_t MimeHelper::CompressedPart::dataRead( char* buffer, size_t size, size_t nitems, void* userData )
+{
+  return ((CompressedPart*)(userData))->compressor->read( buffer, size * nitems );
+}
+
+// static
+int MimeHelper::CompressedPart::dataSeek( void* userData, curl_off_t offset, int origin )
+{
+  CompressedPart& part{ *((CompressedPart*)(userData)) };
+
+  // Compressed data can only be regenerated from the start.
+  if ( ( origin != SEEK_SET ) || ( offset != 0 ) )
+  {
+    return CURL_SEEKFUNC_CANTSEEK;
+  }
+
+  if ( part.dataReader )
+  {
+    const int rc{ MimeHelper::dataSeek( part.dataReader, 0, SEEK_SET ) };
+    if ( rc != CURL_SEEKFUNC_OK )
+    {
+      return rc;
+    }
+  }
+  else if ( part.file )
+  {
+    part.file->offset = 0;
+  }
+  else
+  {
+    part.memory.offset = 0;
+  }
+
+  return part.compressor->reset() ? CURL_SEEKFUNC_OK : CURL_SEEKFUNC_FAIL;
+}
+
 // static
 size_t MimeHelper::dataRead( char* buffer, size_t size, size_t nitems, void* userData )
 {
@@ -102,7 +300,13 @@ size_t MimeHelper::dataRead( char* buffer, size_t size, size_t nitems, void* use
 // static
 int MimeHelper::dataSeek( void* userData, curl_off_t offset, int origin )
 {
-  return ((mime::MimePart::DataReader*)(userData))->dataSeekFn( offset, origin );
+  const auto& dataSeekFn{ ((mime::MimePart::DataReader*)(userData))->dataSeekFn };
+  if ( !dataSeekFn )
+  {
+    // e.g. a retried request whose data cannot be rewound.
+    return CURL_SEEKFUNC_CANTSEEK;
+  }
+  return dataSeekFn( offset, origin );
 }
 
 
@@ -24,8 +24,15 @@
 #include <lb/url/http/Response.h>
 #include <lb/url/mime/MimePart.h>
 
+#include "Compressor.h"
+#include "FileRegion.h"
+
 #include <curl/curl.h>
 
+#include <memory>
+#include <string_view>
+#include <vector>
+
 
 namespace lb
 {
@@ -39,17 +46,62 @@ namespace url
 struct MimeHelper
 {
   MimeHelper(); //!< No mime
-  MimeHelper( mime::Mime mp );
+
+  /** \brief Throws std::runtime_error if a part is a file that cannot be used. */
+  MimeHelper( mime::Mime mp, http::Request::Compression = {} );
   ~MimeHelper();
 
   bool setOptions( CURL* );
 
+  /** \brief Totals across all compressed parts, \sa http::Request::compression. */
+  size_t numUncompressedBytes() const;
+  size_t numCompressedBytes() const;
+
   // C-style callbacks used by libcurl. The void* is the address of the relevant mime::MimePart::DataReader instance.
   static size_t dataRead( char *buffer, size_t size, size_t nitems, void* userData );
   static int dataSeek( void* userData, curl_off_t offset, int origin );
 
+  /** \brief A part whose data is in memory, passed to libcurl without a copy. */
+  struct MemoryPart
+  {
+    std::string_view data;
+    size_t offset{ 0 };
+
+    size_t read( char* buffer, size_t numBytes );
+
+    // C-style callbacks used by libcurl. The void* is the address of the MemoryPart.
+    static size_t dataRead( char *buffer, size_t size, size_t nitems, void* userData );
+    static int dataSeek( void* userData, curl_off_t offset, int origin );
+  };
+
+  /** \brief A part whose data is compressed as it is read. */
+  struct CompressedPart
+  {
+    std::unique_ptr<Compressor> compressor;
+
+    mime::MimePart::DataReader* dataReader{ nullptr }; //!< Null if reading \a file or \a memory.
+    FileRegion* file{ nullptr };                        //!< Null if reading \a memory.
+    MemoryPart memory;
+
+    size_t read( char* buffer, size_t numBytes );
+
+    // C-style callbacks used by libcurl. The void* is the address of the CompressedPart.
+    static size_t dataRead( char *buffer, size_t size, size_t nitems, void* userData );
+    static int dataSeek( void* userData, curl_off_t offset, int origin );
+  };
+
   mime::Mime mime;
 
+  http::Request::Compression compression;
+
+  std::vector< std::unique_ptr<CompressedPart> > compressedParts;
+
+  //! Reserved up front so that the addresses passed to libcurl stay valid.
+  std::vector<MemoryPart> memoryParts;
+
+  //! Indexed as mime.parts, null for parts that are not files.
+  std::vector< std::unique_ptr<FileRegion> > fileParts;
+
   curl_mime* mimeParts { nullptr };
 };
 
@@ -0,0 +1,70 @@
+/*
+    Copyright (C) 2023  Paul Fotheringham (LinuxBrickie)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "PrewarmHandler.h"
+
+
+namespace lb
+{
+
+
+namespace url
+{
+
+
+PrewarmHandler::PrewarmHandler( std::string u, Callback c )
+  : url{ std::move( u ) }
+  , callback{ std::move( c ) }
+{
+  curl_easy_setopt( easyHandle, CURLOPT_URL, url.c_str() );
+  curl_easy_setopt( easyHandle, CURLOPT_NOBODY, 1L );
+}
+
+void PrewarmHandler::transferDone( CURLcode r )
+{
+  result = r;
+}
+
+RequestHandler::Status PrewarmHandler::respond( ResponseCode rc, std::string )
+{
+  std::optional<std::string> address;
+
+  char* ip{ nullptr };
+  if ( ( rc == ResponseCode::eSuccess )
+    && ( result == CURLE_OK )
+    && ( curl_easy_getinfo( easyHandle, CURLINFO_PRIMARY_IP, &ip ) == CURLE_OK )
+    && ip )
+  {
+    address = ip;
+  }
+
+  callback( std::move( address ) );
+
+  return Status::eFinished;
+}
+
+size_t PrewarmHandler::processReceivedData( const char*, size_t numBytes )
+{
+  // There should be no body but discard it if there is.
+  return numBytes;
+}
+
+
+} // End of namespace url
+
+
+} // End of namespace lb
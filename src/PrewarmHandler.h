@@ -0,0 +1,74 @@
+#ifndef LIB_LB_URL_PREWARMHANDLER_H
+#define LIB_LB_URL_PREWARMHANDLER_H
+
+/*
+    Copyright (C) 2023  Paul Fotheringham (LinuxBrickie)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// Private header
+
+#include "RequestHandler.h"
+
+#include <functional>
+#include <optional>
+#include <string>
+
+
+namespace lb
+{
+
+
+namespace url
+{
+
+
+/** \brief Opens a connection to a host so that it is left idle in the
+           connection pool, \sa Requester::prewarm.
+
+    A HEAD request is made for the root of the host. Any HTTP response at all
+    means that the connection, including any TLS handshake, was established.
+ */
+struct PrewarmHandler : public RequestHandler
+{
+  /** \brief Passed the address connected to or nothing if the connection
+             failed.
+   */
+  using Callback = std::function< void( std::optional<std::string> address ) >;
+
+  PrewarmHandler( std::string url, Callback );
+
+  virtual void transferDone( CURLcode );
+
+protected:
+  virtual Status respond( ResponseCode, std::string );
+
+  virtual size_t processReceivedData( const char* data, size_t numBytes );
+
+private:
+  std::string url;
+  Callback callback;
+
+  CURLcode result{ CURLE_OK };
+};
+
+
+} // End of namespace url
+
+
+} // End of namespace lb
+
+
+#endif // LIB_LB_URL_PREWARMHANDLER_H
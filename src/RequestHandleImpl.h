@@ -0,0 +1,92 @@
+#ifndef LIB_LB_URL_REQUESTHANDLEIMPL_H
+#define LIB_LB_URL_REQUESTHANDLEIMPL_H
+
+/*
+    Copyright (C) 2023  Paul Fotheringham (LinuxBrickie)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// Private header
+
+#include <lb/url/MoveOnlyFunction.h>
+#include <lb/url/RequestHandle.h>
+
+#include <atomic>
+
+
+namespace lb
+{
+
+
+namespace url
+{
+
+
+struct RequestHandle::Impl
+{
+  enum class Command
+  {
+    eCancel,
+    eResume
+  };
+
+  using Poster = MoveOnlyFunction< void( Command ) >;
+
+  static RequestHandle create( Poster p )
+  {
+    RequestHandle handle;
+    handle.d = std::make_shared<RequestHandle::Impl>( std::move( p ) );
+    return handle;
+  }
+
+  Impl( Poster p )
+    : poster{ std::move( p ) }
+  {
+  }
+
+  void cancel()
+  {
+    // Only the first call needs to reach the Requester.
+    if ( !cancelled.exchange( true ) )
+    {
+      poster( Command::eCancel );
+    }
+  }
+
+  void resume()
+  {
+    if ( !cancelled )
+    {
+      poster( Command::eResume );
+    }
+  }
+
+  std::atomic<bool> cancelled{ false };
+
+  /** \brief Passes a command to the Requester to carry out on its thread.
+
+      Must be safe to call from any thread and after the Requester is gone.
+   */
+  const Poster poster;
+};
+
+
+} // End of namespace url
+
+
+} // End of namespace lb
+
+
+#endif // LIB_LB_URL_REQUESTHANDLEIMPL_H
@@ -17,6 +17,7 @@
 
 #include "RequestHandler.h"
 
+#include "HostLimiter.h"
 #include "HttpHandler.h"
 
 #include <stdexcept>
@@ -45,6 +46,11 @@ RequestHandler::RequestHandler()
 
 RequestHandler::RequestHandler( RequestHandler&& moveFrom )
   : easyHandle{ moveFrom.easyHandle }
+  , receivedData{ std::move( moveFrom.receivedData ) }
+  , queueWait{ moveFrom.queueWait }
+  , id{ moveFrom.id }
+  , hostSlot{ std::move( moveFrom.hostSlot ) }
+  , cachedHostKey{ std::move( moveFrom.cachedHostKey ) }
 {
   moveFrom.easyHandle = nullptr;
   curl_easy_setopt( easyHandle, CURLOPT_WRITEDATA, this );
@@ -63,10 +69,56 @@ CURL* RequestHandler::getHandle() const
   return easyHandle;
 }
 
+size_t RequestHandler::getId() const
+{
+  return id;
+}
+
+void RequestHandler::setId( size_t i )
+{
+  id = i;
+}
+
 void RequestHandler::processInfo()
 {
 }
 
+void RequestHandler::tune( const ConnectionTuning& tuning )
+{
+  if ( tuning.tcpNoDelay )
+  {
+    curl_easy_setopt( easyHandle, CURLOPT_TCP_NODELAY, long( *tuning.tcpNoDelay ) );
+  }
+  if ( tuning.tcpKeepAlive )
+  {
+    curl_easy_setopt( easyHandle, CURLOPT_TCP_KEEPALIVE, long( *tuning.tcpKeepAlive ) );
+  }
+  if ( tuning.tcpKeepIdleSeconds )
+  {
+    curl_easy_setopt( easyHandle, CURLOPT_TCP_KEEPIDLE, *tuning.tcpKeepIdleSeconds );
+  }
+  if ( tuning.tcpKeepIntervalSeconds )
+  {
+    curl_easy_setopt( easyHandle, CURLOPT_TCP_KEEPINTVL, *tuning.tcpKeepIntervalSeconds );
+  }
+  if ( tuning.receiveBufferSize )
+  {
+    curl_easy_setopt( easyHandle, CURLOPT_BUFFERSIZE, *tuning.receiveBufferSize );
+  }
+  if ( tuning.uploadBufferSize )
+  {
+    curl_easy_setopt( easyHandle, CURLOPT_UPLOAD_BUFFERSIZE, *tuning.uploadBufferSize );
+  }
+  if ( tuning.tcpFastOpen )
+  {
+    curl_easy_setopt( easyHandle, CURLOPT_TCP_FASTOPEN, long( *tuning.tcpFastOpen ) );
+  }
+  if ( tuning.maxConnectionAgeSeconds )
+  {
+    curl_easy_setopt( easyHandle, CURLOPT_MAXAGE_CONN, *tuning.maxConnectionAgeSeconds );
+  }
+}
+
 RequestHandler::Status RequestHandler::respond( ResponseCode rc )
 {
   switch ( rc )
@@ -83,6 +135,16 @@ bool RequestHandler::updatePersisting()
   return update();
 }
 
+curl_socket_t RequestHandler::activeSocket() const
+{
+  curl_socket_t socket;
+  if ( curl_easy_getinfo( easyHandle, CURLINFO_ACTIVESOCKET, &socket ) != CURLE_OK )
+  {
+    return CURL_SOCKET_BAD;
+  }
+  return socket;
+}
+
 bool RequestHandler::closePersisting()
 {
   return close();
@@ -100,16 +162,74 @@ bool RequestHandler::close()
   return true;
 }
 
+void RequestHandler::transferDone( CURLcode )
+{
+  // Do nothing
+}
+
+std::optional<std::chrono::milliseconds> RequestHandler::retryDelay( CURLcode )
+{
+  // Never retry by default
+  return std::nullopt;
+}
+
+void RequestHandler::restart()
+{
+  receivedData.clear();
+  pausedForMemory = false;
+}
+
+std::optional<std::chrono::milliseconds> RequestHandler::hedgeDelay( LatencyTracker& ) const
+{
+  // Never hedge by default
+  return std::nullopt;
+}
+
+std::unique_ptr<RequestHandler> RequestHandler::createHedge()
+{
+  return {};
+}
+
+Priority RequestHandler::priority() const
+{
+  return Priority::eNormal;
+}
+
+std::string RequestHandler::limitKey() const
+{
+  return {};
+}
+
+const std::string& RequestHandler::hostKey() const
+{
+  if ( !cachedHostKey )
+  {
+    cachedHostKey = limitKey();
+  }
+  return *cachedHostKey;
+}
+
+void RequestHandler::admitted( std::chrono::steady_clock::duration w, std::unique_ptr<HostSlot> slot )
+{
+  queueWait = w;
+  hostSlot = std::move( slot );
+}
+
+size_t RequestHandler::numBufferedBytes() const
+{
+  return receivedData.size();
+}
+
 // static
 size_t RequestHandler::writeCallback( char* data, size_t size, size_t numBytes, void* userData )
 {
-  ((RequestHandler*)(userData))->processReceivedData( data, numBytes );
-  return numBytes;
+  return ((RequestHandler*)(userData))->processReceivedData( data, numBytes );
 }
 
-void RequestHandler::processReceivedData( const char* data, size_t numBytes )
+size_t RequestHandler::processReceivedData( const char* data, size_t numBytes )
 {
   receivedData.append( data, numBytes );
+  return numBytes;
 }
 
 
@@ -20,10 +20,17 @@
 
 // Private header
 
+#include <lb/url/ConnectionTuning.h>
+#include <lb/url/Priority.h>
 #include <lb/url/ResponseCode.h>
 
 #include <curl/curl.h>
 
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <string>
+
 
 namespace lb
 {
@@ -33,6 +40,10 @@ namespace url
 {
 
 
+class HostSlot;
+class LatencyTracker;
+
+
 /** Abstract base class that wraps the easy handle and the receiverd data.
 
     An example subclass is HttpHandler.
@@ -50,8 +61,19 @@ struct RequestHandler
 
   CURL* getHandle() const;
 
+  /** \brief Identifies the request for cancellation, \sa RequestHandle.
+
+      Zero if the request cannot be cancelled. A hedge shares the identifier of
+      the request it duplicates.
+   */
+  size_t getId() const;
+  void setId( size_t );
+
   void processInfo();
 
+  /** \brief Apply the settings that are set in \a tuning to the easy handle. */
+  void tune( const ConnectionTuning& tuning );
+
   enum class Status
   {
     eFinished,
@@ -74,23 +96,108 @@ struct RequestHandler
 
   /** \brief Called periodically by \a Requester if \a respond returned \a ePersisting.
       \return True to keep persisting, false to stop persisting and delete the handler.
+
+      Called on every pass of the \a Requester's loop so should check
+      \a readable before doing anything that costs a system call.
    */
   bool updatePersisting();
 
+  /** \brief The socket of a persisting connection, or CURL_SOCKET_BAD.
+
+      \a Requester polls this alongside libcurl's own sockets and sets
+      \a readable accordingly.
+   */
+  curl_socket_t activeSocket() const;
+
   bool closePersisting();
 
+  /** \brief Called by \a Requester when a transfer completes, before
+             \a retryDelay and \a respond.
+
+      \a result is the CURLcode of the completed transfer. Does nothing by default.
+   */
+  virtual void transferDone( CURLcode result );
+
+  /** \brief Called by \a Requester when a transfer completes, before \a respond.
+      \return The delay before the request should be retried or nothing if the
+              request should be responded to as normal.
+
+      \a result is the CURLcode of the completed transfer.
+   */
+  virtual std::optional<std::chrono::milliseconds> retryDelay( CURLcode result );
+
+  /** \brief Called by \a Requester just before a retry is scheduled.
+
+      The easy handle will already have been removed from the multi handle.
+      Any data received by the failed attempt is discarded.
+   */
+  virtual void restart();
+
+  /** \brief The delay after which the request should be hedged.
+      \return Nothing if the request should not be hedged.
+
+      \a latencies holds recent request latencies for percentile based delays.
+   */
+  virtual std::optional<std::chrono::milliseconds> hedgeDelay( LatencyTracker& latencies ) const;
+
+  /** \brief Create a duplicate of this request to race against it.
+      \return The duplicate or null if the request cannot be duplicated.
+
+      Both this handler and the duplicate respond through the same callback so
+      \a Requester must ensure that only one of them ever responds.
+   */
+  virtual std::unique_ptr<RequestHandler> createHedge();
+
+  /** \brief The priority with which the request is admitted by \a Requester. */
+  virtual Priority priority() const;
+
+  /** \brief The key for Requester::Config::hostLimits, empty for no limits. */
+  virtual std::string limitKey() const;
+
+  /** \brief \a limitKey, only worked out on the first call. */
+  const std::string& hostKey() const;
+
+  /** \brief Called by \a Requester when the request leaves the admission queue.
+
+      \a slot, if any, is held until the handler is destroyed.
+   */
+  void admitted( std::chrono::steady_clock::duration queueWait, std::unique_ptr<HostSlot> slot );
+
+  /** \brief Bytes received and held in memory awaiting the response. */
+  size_t numBufferedBytes() const;
+
+  //! Set whilst paused by Requester to limit memory, \sa Requester::Config::receiveWatermarks
+  bool pausedForMemory{ false };
+
+  //! Set by Requester when a persisting connection has data to read, \sa activeSocket
+  bool readable{ true };
+
 protected:
   virtual Status respond( ResponseCode, std::string ) = 0;
   virtual   bool  update();
   virtual   bool  close();
 
+  /** \brief Consume a chunk of received data.
+      \return \a numBytes or CURL_WRITEFUNC_PAUSE to pause the transfer, in
+              which case the same data is passed again once unpaused.
+
+      By default the data is appended to \a receivedData.
+   */
+  virtual size_t processReceivedData( const char* data, size_t numBytes );
+
   CURL* easyHandle;
   std::string receivedData;
 
+  std::chrono::steady_clock::duration queueWait{ 0 };
+
 private:
-  static size_t writeCallback( char* data, size_t size, size_t numBytes, void* userData );
+  size_t id{ 0 };
+
+  std::unique_ptr<HostSlot> hostSlot;
 
-  void processReceivedData( const char* data, size_t numBytes );
+  mutable std::optional<std::string> cachedHostKey;
+
+  static size_t writeCallback( char* data, size_t size, size_t numBytes, void* userData );
 };
 
 
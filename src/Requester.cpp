@@ -17,17 +17,29 @@
 
 #include <lb/url/Requester.h>
 
+#include "AdmissionQueue.h"
+#include "CompletionQueue.h"
+#include "HostLimiter.h"
 #include "HttpHandler.h"
+#include "LatencyTracker.h"
+#include "PrewarmHandler.h"
+#include "RequestHandleImpl.h"
 #include "RequestHandler.h"
+#include "RetryBudget.h"
+#include "TaskQueue.h"
 #include "WebSocketHandler.h"
 
+#include <algorithm>
 #include <atomic>
 #include <chrono>
 #include <iostream>
+#include <map>
 #include <mutex>
+#include <optional>
 #include <queue>
 #include <thread>
 #include <unordered_map>
+#include <vector>
 
 #include <curl/curl.h>
 
@@ -45,6 +57,8 @@ struct Requester::Private
   template<class T>
   using Lock = std::scoped_lock<T>;
 
+  using Clock = std::chrono::steady_clock;
+
   std::thread thread; //!< running and Response callback thread.
 
   std::atomic<bool> running{ true };
@@ -53,11 +67,29 @@ struct Requester::Private
 
   CURLM* multiHandle{ nullptr };
 
+  /** \brief Work posted from other threads, e.g. by RequestHandle::cancel. */
+  std::shared_ptr<TaskQueue> tasks;
+
+  std::atomic<size_t> nextRequestId{ 1 }; //!< Zero is never used, \sa RequestHandler::getId
+
+  /** \brief Enforces Config::hostLimits. Only accessed on the run() thread.
+
+      Must outlive all request handlers as they may hold a HostSlot.
+   */
+  HostLimiter hostLimiter;
+
   std::mutex pendingRequestsMutex;
 
   using PendingRequests = std::queue< std::unique_ptr<RequestHandler> >;
   PendingRequests pendingRequests; //!< Protected by \a pendingRequestsMutex
 
+  /** \brief Requests waiting for capacity, \sa Config::maxConcurrentRequests.
+
+      Pending requests are moved here on the run() thread, the only thread
+      that accesses it.
+   */
+  AdmissionQueue admissionQueue;
+
   using Requests = std::unordered_map< CURL*, std::unique_ptr<RequestHandler> >;
   Requests requests;
 
@@ -70,9 +102,70 @@ struct Requester::Private
    */
   Requests persistingRequests;
 
+  /** \brief The sockets of persistingRequests passed to curl_multi_poll and
+             the handlers they belong to, in the same order.
+
+      Rebuilt on each pass of run() and only accessed on its thread.
+   */
+  std::vector<curl_waitfd> persistingFDs;
+  std::vector<RequestHandler*> polledPersistingRequests;
+
+  /** \brief Requests waiting to be retried, keyed by the time they are due.
+
+      Only accessed on the run() thread.
+   */
+  using DelayedRequests = std::multimap< Clock::time_point, std::unique_ptr<RequestHandler> >;
+  DelayedRequests delayedRequests;
+
+  RetryBudget retryBudget;
+
+  /** \brief Requests to be hedged keyed by the time the hedge is due.
+
+      Timers are disarmed via \a hedgeTimerLookup if the request completes
+      first. Only accessed on the run() thread, as are all the hedge members.
+   */
+  using HedgeTimers = std::multimap< Clock::time_point, CURL* >;
+  HedgeTimers hedgeTimers;
+  std::unordered_map< CURL*, HedgeTimers::iterator > hedgeTimerLookup;
+
+  /** \brief Links each half of a hedged pair to the other. */
+  struct HedgeLink
+  {
+    CURL* partner;
+    bool isDuplicate; //!< False for the original request.
+  };
+  std::unordered_map< CURL*, HedgeLink > hedgeLinks;
+
+  HostLatencies latencies;
+
+  //! Hedges are paid for like retries, just without a reserve.
+  RetryBudget hedgeBudget;
+
+  /** \brief CURLOPT_RESOLVE entries for hosts pinned by prewarm.
+
+      Only accessed on the run() thread.
+   */
+  curl_slist* pinnedHosts{ nullptr };
+
+  /** \brief Completions of requests made with a tag.
+
+      Pushed to and flushed on the run() thread only.
+   */
+  CompletionQueue completions;
+
+  std::atomic<size_t> numHedged{ 0 };
+  std::atomic<size_t> numHedgeWins{ 0 };
+  std::atomic<size_t> numHedgesDenied{ 0 };
+
   Private( Config c )
     : config{ std::move( c ) }
     , multiHandle{ curl_multi_init() }
+    , tasks{ std::make_shared<TaskQueue>( multiHandle ) }
+    , hostLimiter{ config.defaultHostLimits, config.hostLimits }
+    , admissionQueue{ std::chrono::milliseconds{ config.starvationTimeoutMilliseconds } }
+    , retryBudget{ config.retryBudget.ratio, config.retryBudget.minRetriesPerSecond }
+    , hedgeBudget{ config.hedging.maxFraction, 0 }
+    , completions{ config.completionQueueCapacity, [this]() { curl_multi_wakeup( multiHandle ); } }
     , thread{}
   {
     if ( !multiHandle )
@@ -112,54 +205,473 @@ struct Requester::Private
 
     thread.join();
 
+    // Outstanding RequestHandles may still try to post.
+    tasks->close();
+
     curl_multi_cleanup( multiHandle );
+
+    curl_slist_free_all( pinnedHosts );
   }
 
-  void addRequest( http::Request request, http::Response::Callback response )
+  /** \brief The settings of the named profile, or of Config::tuningProfile if
+             \a name is empty.
+
+      Config is never modified after construction so this is safe to call
+      from any thread.
+   */
+  ConnectionTuning tuningProfile( const std::string& name ) const
   {
-    std::scoped_lock l{ pendingRequestsMutex };
+    const std::string& profile{ name.empty() ? config.tuningProfile : name };
+    if ( profile.empty() )
+    {
+      return {};
+    }
+
+    const auto i{ config.tuningProfiles.find( profile ) };
+    if ( i == config.tuningProfiles.end() )
+    {
+      throw std::runtime_error( "Unknown connection tuning profile: " + profile );
+    }
+    return i->second;
+  }
+
+  RequestHandle addRequest( http::Request request, http::Response::Callback response )
+  {
+    // Resolve the tuning now so that it is carried by the request into any
+    // retries and hedges.
+    request.tuning = tuningProfile( request.tuningProfile ).merge( request.tuning );
+
+    auto handler{ std::make_unique< HttpHandler >( std::move( request ), std::move( response ) ) };
+
+    const size_t id{ nextRequestId++ };
+    handler->setId( id );
+
+    // The task only runs on the run() thread, which this outlives.
+    using Command = RequestHandle::Impl::Command;
+    auto handle{ RequestHandle::Impl::create( [weakTasks = std::weak_ptr<TaskQueue>{ tasks }, this, id]( Command command )
+    {
+      if ( const auto tasks{ weakTasks.lock() } )
+      {
+        tasks->post( [this, id, command]()
+        {
+          switch( command )
+          {
+          case Command::eCancel:
+            cancel( id );
+            break;
+          case Command::eResume:
+            resume( id );
+            break;
+          }
+        } );
+      }
+    } ) };
+
+    handler->bind( handle );
+
+    {
+      std::scoped_lock l{ pendingRequestsMutex };
+
+      pendingRequests.push( std::move( handler ) );
+    }
 
-    pendingRequests.push( std::make_unique< HttpHandler >( std::move( request ), std::move( response ) ) );
+    return handle;
+  }
+
+  RequestHandle addRequest( http::Request request, uint64_t tag )
+  {
+    // Only ever invoked on the run() thread. Captures two words so is stored
+    // inline by http::Response::Callback without allocating.
+    CompletionQueue* queue{ &completions };
+    return addRequest( std::move( request ), [queue, tag]( ResponseCode rc, http::Response r )
+    {
+      queue->push( { tag, rc, std::move( r ) } );
+    } );
   }
 
   void addRequest( ws::Request request, ws::Response::Callback response )
   {
+    auto handler{ std::make_unique< WebSocketHandler >( std::move( request ), std::move( response ), tasks ) };
+    handler->tune( tuningProfile( {} ) );
+
     std::scoped_lock l{ pendingRequestsMutex };
 
-    pendingRequests.push( std::make_unique< WebSocketHandler >( std::move( request ), std::move( response ) ) );
+    pendingRequests.push( std::move( handler ) );
   }
 
-  bool addPendingRequests()
+  std::future<PrewarmResult> prewarm( std::vector<std::string> hosts, size_t connectionsPerHost )
   {
-    bool atLeastOneAdded{ false };
+    // Only accessed on the run() thread once the handlers are pending.
+    struct State
+    {
+      std::promise<PrewarmResult> promise;
+      PrewarmResult result;
+      std::vector<size_t> numOutstanding; //!< For each host.
+      std::vector<std::string> pinKeys;   //!< For each host, "name:port" or empty.
+      size_t numHostsOutstanding{ 0 };
+
+      void finishHost()
+      {
+        if ( --numHostsOutstanding == 0 )
+        {
+          promise.set_value( std::move( result ) );
+        }
+      }
+    };
+    const auto state{ std::make_shared<State>() };
+    auto future{ state->promise.get_future() };
+
+    const ConnectionTuning tuning{ tuningProfile( {} ) };
+
+    std::vector< std::unique_ptr<RequestHandler> > handlers;
+    for ( size_t i = 0; i < hosts.size(); ++i )
+    {
+      state->result.hosts.push_back( { hosts[ i ], 0, {} } );
+      state->numOutstanding.push_back( 0 );
+      state->pinKeys.emplace_back();
+
+      std::string url;
+      if ( CURLU* parsed{ curl_url() } )
+      {
+        char* scheme{ nullptr };
+        char* host{ nullptr };
+        char* port{ nullptr };
+        if ( ( curl_url_set( parsed, CURLUPART_URL, hosts[ i ].c_str(), CURLU_GUESS_SCHEME ) == CURLUE_OK )
+          && ( curl_url_get( parsed, CURLUPART_SCHEME, &scheme, 0 ) == CURLUE_OK )
+          && ( curl_url_get( parsed, CURLUPART_HOST, &host, 0 ) == CURLUE_OK )
+          && ( curl_url_get( parsed, CURLUPART_PORT, &port, CURLU_DEFAULT_PORT ) == CURLUE_OK ) )
+        {
+          url = std::string( scheme ) + "://" + host + ':' + port + '/';
+          // IPv6 literals have nothing to resolve.
+          if ( host[ 0 ] != '[' )
+          {
+            state->pinKeys[ i ] = std::string( host ) + ':' + port;
+          }
+        }
+        curl_free( scheme );
+        curl_free( host );
+        curl_free( port );
+        curl_url_cleanup( parsed );
+      }
+
+      if ( url.empty() || ( connectionsPerHost == 0 ) )
+      {
+        continue;
+      }
 
+      state->numOutstanding[ i ] = connectionsPerHost;
+      ++state->numHostsOutstanding;
+
+      for ( size_t c = 0; c < connectionsPerHost; ++c )
+      {
+        auto handler{ std::make_unique<PrewarmHandler>( url, [this, state, i]( std::optional<std::string> address )
+        {
+          auto& host{ state->result.hosts[ i ] };
+          if ( address )
+          {
+            ++host.numConnections;
+            if ( std::find( host.pinnedAddresses.begin(), host.pinnedAddresses.end(), *address ) == host.pinnedAddresses.end() )
+            {
+              host.pinnedAddresses.push_back( *address );
+            }
+          }
+
+          if ( --state->numOutstanding[ i ] == 0 )
+          {
+            // Nothing is pinned once the Requester is shutting down.
+            if ( state->pinKeys[ i ].empty() || !running )
+            {
+              host.pinnedAddresses.clear();
+            }
+            pin( state->pinKeys[ i ], host.pinnedAddresses );
+            state->finishHost();
+          }
+        } ) };
+        handler->tune( tuning );
+        handlers.push_back( std::move( handler ) );
+      }
+    }
+
+    if ( state->numHostsOutstanding == 0 )
+    {
+      state->promise.set_value( std::move( state->result ) );
+      return future;
+    }
+
+    {
+      std::scoped_lock l{ pendingRequestsMutex };
+      for ( auto& handler : handlers )
+      {
+        pendingRequests.push( std::move( handler ) );
+      }
+    }
+
+    // Wake the run() thread rather than waiting for the poll to time out.
+    curl_multi_wakeup( multiHandle );
+
+    return future;
+  }
+
+  /** \brief Resolve "name:port" to \a addresses for all subsequent transfers. */
+  void pin( const std::string& key, const std::vector<std::string>& addresses )
+  {
+    if ( key.empty() || addresses.empty() )
+    {
+      return;
+    }
+
+    std::string entry{ key + ':' };
+    for ( const auto& address : addresses )
+    {
+      if ( entry.back() != ':' )
+      {
+        entry += ',';
+      }
+      entry += ( address.find( ':' ) == std::string::npos ) ? address : '[' + address + ']';
+    }
+
+    // A later entry for the same name and port replaces an earlier one.
+    pinnedHosts = curl_slist_append( pinnedHosts, entry.c_str() );
+  }
+
+  void queuePendingRequests()
+  {
     std::scoped_lock l{ pendingRequestsMutex };
     while ( !pendingRequests.empty() )
     {
-      auto& pendingRequest{ pendingRequests.front() };
-      if ( addPendingRequest( std::move( pendingRequest ) ) )
+      admissionQueue.push( std::move( pendingRequests.front() ) );
+      pendingRequests.pop();
+    }
+  }
+
+  /** \return True if any tasks were run. */
+  bool runTasks()
+  {
+    // Take the tasks before queueing pending requests. A task, such as a
+    // cancellation, is always posted after the request it refers to was made
+    // so the request is then guaranteed to be somewhere the task can find it.
+    auto taken{ tasks->take() };
+    if ( taken.empty() )
+    {
+      return false;
+    }
+
+    queuePendingRequests();
+
+    for ( auto& task : taken )
+    {
+      task();
+    }
+
+    return true;
+  }
+
+  /** \brief Remove request \a id from wherever it is and respond eAborted. */
+  void cancel( size_t id )
+  {
+    if ( auto request{ admissionQueue.remove( id ) } )
+    {
+      request->respond( ResponseCode::eAborted );
+      return;
+    }
+
+    for ( auto D = delayedRequests.begin(); D != delayedRequests.end(); ++D )
+    {
+      if ( D->second->getId() == id )
+      {
+        auto request{ std::move( D->second ) };
+        delayedRequests.erase( D );
+        request->respond( ResponseCode::eAborted );
+        return;
+      }
+    }
+
+    // In flight, possibly as both halves of a hedged pair.
+    std::vector<CURL*> easyHandles;
+    for ( const auto&[easyHandle, request] : requests )
+    {
+      if ( request->getId() == id )
+      {
+        easyHandles.push_back( easyHandle );
+      }
+    }
+
+    if ( easyHandles.empty() )
+    {
+      // Already complete.
+      return;
+    }
+
+    // Only the original of a hedged pair responds.
+    CURL* responder{ easyHandles.front() };
+    for ( const auto easyHandle : easyHandles )
+    {
+      const auto L{ hedgeLinks.find( easyHandle ) };
+      if ( L != hedgeLinks.end() )
+      {
+        if ( !L->second.isDuplicate )
+        {
+          responder = easyHandle;
+        }
+        hedgeLinks.erase( L );
+      }
+      disarmHedge( easyHandle );
+      curl_multi_remove_handle( multiHandle, easyHandle );
+    }
+
+    auto request{ std::move( requests.at( responder ) ) };
+    for ( const auto easyHandle : easyHandles )
+    {
+      requests.erase( easyHandle );
+    }
+
+    request->respond( ResponseCode::eAborted );
+  }
+
+  /** \brief Unpause request \a id if in flight.
+
+      Resumes both receiving, \sa http::Request::BodySink, and sending,
+      \sa mime::MimePart::DataReader::rcReadPause.
+   */
+  void resume( size_t id )
+  {
+    for ( const auto&[easyHandle, request] : requests )
+    {
+      if ( request->getId() == id )
+      {
+        // Leave receiving to applyReceiveWatermarks() if paused to save memory
+        // but always resume sending, which uses no receive buffer.
+        curl_easy_pause( easyHandle, request->pausedForMemory ? CURLPAUSE_RECV : CURLPAUSE_CONT );
+        return;
+      }
+    }
+  }
+
+  /** \brief Pause or resume transfers to keep within Config::receiveWatermarks.
+      \return True if any transfers were resumed.
+   */
+  bool applyReceiveWatermarks()
+  {
+    const auto& watermarks{ config.receiveWatermarks };
+    if ( ( watermarks.highBytes == 0 ) || requests.empty() )
+    {
+      return false;
+    }
+
+    size_t numBufferedBytes{ 0 };
+    RequestHandler* largestRunning{ nullptr };
+    RequestHandler* smallestPaused{ nullptr };
+    size_t numRunning{ 0 };
+    for ( const auto&[easyHandle, request] : requests )
+    {
+      const size_t numBytes{ request->numBufferedBytes() };
+      numBufferedBytes += numBytes;
+
+      if ( request->pausedForMemory )
+      {
+        if ( !smallestPaused || ( numBytes < smallestPaused->numBufferedBytes() ) )
+        {
+          smallestPaused = request.get();
+        }
+      }
+      else
+      {
+        ++numRunning;
+        if ( !largestRunning || ( numBytes > largestRunning->numBufferedBytes() ) )
+        {
+          largestRunning = request.get();
+        }
+      }
+    }
+
+    const auto setPaused = [this]( RequestHandler& request, bool paused )
+    {
+      if ( curl_easy_pause( request.getHandle(), paused ? CURLPAUSE_RECV : CURLPAUSE_CONT ) == CURLE_OK )
+      {
+        request.pausedForMemory = paused;
+      }
+    };
+
+    bool resumed{ false };
+    if ( numBufferedBytes <= watermarks.lowBytes )
+    {
+      for ( const auto&[easyHandle, request] : requests )
+      {
+        if ( request->pausedForMemory )
+        {
+          setPaused( *request, false );
+          resumed = true;
+        }
+      }
+    }
+    else if ( numRunning == 0 )
+    {
+      // Never pause everything or nothing will complete to free memory.
+      setPaused( *smallestPaused, false );
+      resumed = true;
+    }
+    else if ( ( numBufferedBytes > watermarks.highBytes ) && ( numRunning > 1 ) )
+    {
+      setPaused( *largestRunning, true );
+    }
+    return resumed;
+  }
+
+  bool addPendingRequests()
+  {
+    queuePendingRequests();
+
+    bool atLeastOneAdded{ false };
+
+    const auto canAdmit = [this]( const std::string& key ) { return hostLimiter.canAdmit( key ); };
+
+    while ( hasCapacity() )
+    {
+      auto[pendingRequest, queueWait]{ admissionQueue.pop( canAdmit ) };
+      if ( !pendingRequest )
+      {
+        break;
+      }
+
+      pendingRequest->admitted( queueWait, hostLimiter.admit( pendingRequest->hostKey() ) );
+
+      if ( addPendingRequest( pendingRequest ) )
       {
         atLeastOneAdded = true;
       }
       else
       {
-        // Could avoid sending this just now whilst the mutex is locked but that
-        // can be done later, it ought not to be a common case.
         pendingRequest->respond( ResponseCode::eSendFailure );
       }
-      pendingRequests.pop();
     }
 
     return atLeastOneAdded;
   }
 
-  bool addPendingRequest( std::unique_ptr<RequestHandler> request )
+  bool hasCapacity() const
+  {
+    return ( config.maxConcurrentRequests == 0 )
+        || ( requests.size() < config.maxConcurrentRequests );
+  }
+
+  /** \brief Add to the multi handle, only taking ownership on success. */
+  bool addPendingRequest( std::unique_ptr<RequestHandler>& request )
   {
     try
     {
       const auto easyHandle{ request->getHandle() };
 
-      curl_multi_add_handle( multiHandle, easyHandle );
+      if ( pinnedHosts )
+      {
+        curl_easy_setopt( easyHandle, CURLOPT_RESOLVE, pinnedHosts );
+      }
+
+      if ( curl_multi_add_handle( multiHandle, easyHandle ) != CURLM_OK )
+      {
+        return false;
+      }
+
+      armHedge( *request );
 
       requests.emplace( std::piecewise_construct
                       , std::forward_as_tuple( easyHandle )
@@ -170,10 +682,229 @@ struct Requester::Private
       return false;
     }
 
+    retryBudget.deposit();
+
     return true;
   }
 
-  bool processInfo( CURL* easyHandle )
+  /** \brief Re-add any requests whose retry delay has expired.
+
+      A retry keeps its HostSlot but needs a rate limit token like any other
+      request. If there is none it is delayed until one is due.
+   */
+  bool addDelayedRequests()
+  {
+    bool atLeastOneAdded{ false };
+
+    const auto now{ Clock::now() };
+    while ( !delayedRequests.empty() && ( delayedRequests.begin()->first <= now ) )
+    {
+      auto request{ std::move( delayedRequests.begin()->second ) };
+      delayedRequests.erase( delayedRequests.begin() );
+
+      if ( !hostLimiter.takeToken( request->hostKey() ) )
+      {
+        // Always later than now so will not be revisited by this loop.
+        delayedRequests.emplace( hostLimiter.tokenDue( request->hostKey() ), std::move( request ) );
+        continue;
+      }
+
+      const auto easyHandle{ request->getHandle() };
+      if ( curl_multi_add_handle( multiHandle, easyHandle ) == CURLM_OK )
+      {
+        requests.emplace( easyHandle, std::move( request ) );
+        atLeastOneAdded = true;
+      }
+      else
+      {
+        request->respond( ResponseCode::eSendFailure );
+      }
+    }
+
+    return atLeastOneAdded;
+  }
+
+  void armHedge( RequestHandler& request )
+  {
+    if ( const auto delay{ request.hedgeDelay( latencies.at( request.hostKey() ) ) } )
+    {
+      const auto easyHandle{ request.getHandle() };
+      hedgeTimerLookup[ easyHandle ] = hedgeTimers.emplace( Clock::now() + *delay, easyHandle );
+      hedgeBudget.deposit();
+    }
+  }
+
+  void disarmHedge( CURL* easyHandle )
+  {
+    const auto I{ hedgeTimerLookup.find( easyHandle ) };
+    if ( I != hedgeTimerLookup.end() )
+    {
+      hedgeTimers.erase( I->second );
+      hedgeTimerLookup.erase( I );
+    }
+  }
+
+  /** \brief Issue duplicates of any requests whose hedge delay has expired.
+
+      A duplicate is admitted through hostLimiter like any other request. If
+      the host is at its limit the duplicate is not issued, and counted as
+      denied, rather than adding to the load on a host that is already busy.
+   */
+  bool addDueHedges()
+  {
+    bool atLeastOneAdded{ false };
+
+    const auto now{ Clock::now() };
+    while ( !hedgeTimers.empty() && ( hedgeTimers.begin()->first <= now ) )
+    {
+      CURL*const original{ hedgeTimers.begin()->second };
+      hedgeTimerLookup.erase( original );
+      hedgeTimers.erase( hedgeTimers.begin() );
+
+      const auto I{ requests.find( original ) };
+      if ( I == requests.end() )
+      {
+        continue;
+      }
+
+      const std::string& hostKey{ I->second->hostKey() };
+      if ( !hostLimiter.canAdmit( hostKey ) || !hedgeBudget.tryWithdraw() )
+      {
+        ++numHedgesDenied;
+        continue;
+      }
+
+      std::unique_ptr<RequestHandler> hedge;
+      try
+      {
+        hedge = I->second->createHedge();
+      }
+      catch( const std::runtime_error& )
+      {
+        // Counted as denied, the budget spent on it is not refunded.
+        ++numHedgesDenied;
+        continue;
+      }
+
+      if ( !hedge )
+      {
+        continue;
+      }
+
+      hedge->setId( I->second->getId() );
+      hedge->admitted( {}, hostLimiter.admit( hostKey ) );
+
+      CURL*const duplicate{ hedge->getHandle() };
+      if ( curl_multi_add_handle( multiHandle, duplicate ) != CURLM_OK )
+      {
+        continue;
+      }
+
+      requests.emplace( duplicate, std::move( hedge ) );
+      hedgeLinks[ original ]  = { duplicate, false };
+      hedgeLinks[ duplicate ] = { original, true };
+      ++numHedged;
+      atLeastOneAdded = true;
+    }
+
+    return atLeastOneAdded;
+  }
+
+  /** \brief Deal with the completion of one half of a hedged pair.
+      \return False if the completed transfer lost and has been discarded.
+
+      The first successful transfer wins and the other is cancelled. If the
+      first to complete failed then it is discarded and the other carries on
+      alone. Either way the pair is no longer linked.
+   */
+  bool processHedge( CURL* easyHandle, CURLcode result )
+  {
+    const auto L{ hedgeLinks.find( easyHandle ) };
+    if ( L == hedgeLinks.end() )
+    {
+      return true;
+    }
+
+    const HedgeLink link{ L->second };
+    hedgeLinks.erase( L );
+    hedgeLinks.erase( link.partner );
+
+    long httpResponseCode{ 0 };
+    const bool succeeded
+    {
+      ( result == CURLE_OK )
+      && ( curl_easy_getinfo( easyHandle, CURLINFO_RESPONSE_CODE, &httpResponseCode ) == CURLE_OK )
+      && ( httpResponseCode > 0 )
+      && ( httpResponseCode < 500 )
+    };
+
+    // The loser is discarded without responding.
+    CURL*const loser{ succeeded ? link.partner : easyHandle };
+    curl_multi_remove_handle( multiHandle, loser );
+    requests.erase( loser );
+
+    if ( succeeded && link.isDuplicate )
+    {
+      ++numHedgeWins;
+    }
+
+    return succeeded;
+  }
+
+  /** \brief Gather the sockets of persistingRequests into \a persistingFDs so
+             that they are only updated once there is data to read.
+   */
+  void collectPersistingFDs()
+  {
+    persistingFDs.clear();
+    polledPersistingRequests.clear();
+
+    std::scoped_lock l( persistingRequestsMutex );
+    for ( auto&[easyHandle, request] : persistingRequests )
+    {
+      const curl_socket_t socket{ request->activeSocket() };
+      if ( socket == CURL_SOCKET_BAD )
+      {
+        // Cannot be polled so fall back to reading it on every pass.
+        request->readable = true;
+        continue;
+      }
+
+      persistingFDs.push_back( { socket, CURL_WAIT_POLLIN, 0 } );
+      polledPersistingRequests.push_back( request.get() );
+    }
+  }
+
+  /** \brief The poll timeout, shortened if a timer is due sooner. */
+  int pollTimeoutMilliseconds() const
+  {
+    std::chrono::milliseconds timeout{ config.pollTimeoutMilliseconds };
+    const auto shortenTo = [&timeout]( Clock::time_point due )
+    {
+      const auto untilDue{ std::chrono::ceil<std::chrono::milliseconds>( due - Clock::now() ) };
+      timeout = std::clamp( untilDue, std::chrono::milliseconds{ 0 }, timeout );
+    };
+
+    if ( !delayedRequests.empty() )
+    {
+      shortenTo( delayedRequests.begin()->first );
+    }
+    if ( !hedgeTimers.empty() )
+    {
+      shortenTo( hedgeTimers.begin()->first );
+    }
+    if ( !admissionQueue.empty() && hasCapacity() )
+    {
+      // Queued requests may be waiting on a rate limit token.
+      if ( const auto due{ hostLimiter.nextTokenDue() } )
+      {
+        shortenTo( *due );
+      }
+    }
+    return int( timeout.count() );
+  }
+
+  bool processInfo( CURL* easyHandle, CURLcode result )
   {
     const auto I{ requests.find( easyHandle ) };
     if ( I == requests.end() )
@@ -182,6 +913,35 @@ struct Requester::Private
     }
 
     auto& request{ I->second };
+
+    disarmHedge( easyHandle );
+
+    if ( !processHedge( easyHandle, result ) )
+    {
+      return true;
+    }
+
+    request->transferDone( result );
+
+    if ( const auto delay{ request->retryDelay( result ) } )
+    {
+      if ( retryBudget.tryWithdraw() )
+      {
+        curl_multi_remove_handle( multiHandle, easyHandle );
+        request->restart();
+        delayedRequests.emplace( Clock::now() + *delay, std::move( request ) );
+        requests.erase( I );
+        return true;
+      }
+    }
+
+    curl_off_t totalTimeMicroseconds;
+    if ( ( result == CURLE_OK )
+      && ( curl_easy_getinfo( easyHandle, CURLINFO_TOTAL_TIME_T, &totalTimeMicroseconds ) == CURLE_OK ) )
+    {
+      latencies.at( request->hostKey() ).add( std::chrono::microseconds{ totalTimeMicroseconds } );
+    }
+
     switch( request->respond( ResponseCode::eSuccess ) )
     {
     case RequestHandler::Status::eFinished:
@@ -208,9 +968,17 @@ struct Requester::Private
 
     while ( running )
     {
+      // 0. Run anything posted from other threads, e.g. cancellations. These
+      //    may unpause transfers which then need curl_multi_perform to carry
+      //    on as there may be no fd activity to prompt it.
+      const bool ranTasks{ runTasks() };
+
       // 1. Add any new requests and call curl_multi_perform to ensure they get
       //    started.
-      if ( addPendingRequests() )
+      const bool addedPending{ addPendingRequests() };
+      const bool addedDelayed{ addDelayedRequests() };
+      const bool addedHedges{ addDueHedges() };
+      if ( ranTasks || addedPending || addedDelayed || addedHedges )
       {
         //std::cout << "  Perform..." << std::endl;
         curl_multi_perform( multiHandle, &numHandlesRunning );
@@ -221,12 +989,26 @@ struct Requester::Private
       //    requests are not delayed in being added by step 1. If any file
       //    descriptors have activity then we call curl_mutli_perform to deal
       //    with any data they may have.
+      completions.flush();
+
+      // Persisting connections are polled too, so that they are read as soon
+      // as data arrives and idle ones are not read at all.
+      collectPersistingFDs();
+
       int numActiveFDs;
-      const auto pollRC{ curl_multi_poll( multiHandle, nullptr, 0, config.pollTimeoutMilliseconds, &numActiveFDs ) };
+      const auto pollRC{ curl_multi_poll( multiHandle
+                                        , persistingFDs.data()
+                                        , unsigned( persistingFDs.size() )
+                                        , pollTimeoutMilliseconds()
+                                        , &numActiveFDs ) };
       //std::cout << numActiveFDs << " FDs" << std::endl;
       switch ( pollRC )
       {
       case CURLM_OK:
+        for ( size_t i = 0; i < persistingFDs.size(); ++i )
+        {
+          polledPersistingRequests[ i ]->readable = ( persistingFDs[ i ].revents != 0 );
+        }
         if ( numActiveFDs > 0 )
         {
           curl_multi_perform( multiHandle, &numHandlesRunning );
@@ -242,8 +1024,17 @@ struct Requester::Private
       //    when new requests are added).
       read();
 
+      if ( applyReceiveWatermarks() )
+      {
+        curl_multi_perform( multiHandle, &numHandlesRunning );
+      }
+
+      // Wake anyone waiting in pollCompletions once for the whole batch.
+      completions.flush();
+
       // Now update any persisting connections. These are unaffected by the
-      // curl_multi_perform above.
+      // curl_multi_perform above. Any that became persisting since the poll
+      // are still marked readable so are read straight away.
       std::vector< Requests::iterator > toClose;
       {
         std::scoped_lock l( persistingRequestsMutex );
@@ -263,11 +1054,28 @@ struct Requester::Private
       }
     }
 
-    // Abort any requests that are still not complete.
+    // Abort any requests that are still not complete, including any made
+    // since the last pass so that every callback is called.
+    queuePendingRequests();
+    while ( auto request{ admissionQueue.pop( []( const std::string& ) { return true; } ).request } )
+    {
+      request->respond( ResponseCode::eAborted );
+    }
     for ( auto& request : requests )
+    {
+      // Only one half of a hedged pair may respond.
+      const auto L{ hedgeLinks.find( request.first ) };
+      if ( ( L != hedgeLinks.end() ) && L->second.isDuplicate )
+      {
+        continue;
+      }
+      request.second->respond( ResponseCode::eAborted );
+    }
+    for ( auto& request : delayedRequests )
     {
       request.second->respond( ResponseCode::eAborted );
     }
+    completions.flush();
   }
 
   void read()
@@ -281,7 +1089,7 @@ struct Requester::Private
         if ( m && (m->msg == CURLMSG_DONE) )
         {
           CURL*const e{ m->easy_handle };
-          if ( !processInfo( e ) )
+          if ( !processInfo( e, m->data.result ) )
           {
             std::cerr << "Read info for unknown curl easy handle" << std::endl;
           }
@@ -303,9 +1111,19 @@ Requester::Requester( Config c )
 
 Requester::~Requester() = default;
 
-void Requester::makeRequest( http::Request request, http::Response::Callback response )
+RequestHandle Requester::makeRequest( http::Request request, http::Response::Callback response )
 {
-  d->addRequest( std::move( request ), std::move( response ) );
+  return d->addRequest( std::move( request ), std::move( response ) );
+}
+
+RequestHandle Requester::makeRequest( http::Request request, uint64_t tag )
+{
+  return d->addRequest( std::move( request ), tag );
+}
+
+size_t Requester::pollCompletions( Completion* completions, size_t maxNumCompletions, std::chrono::milliseconds timeout )
+{
+  return d->completions.pop( completions, maxNumCompletions, timeout );
 }
 
 void Requester::makeRequest( ws::Request request, ws::Response::Callback response )
@@ -313,6 +1131,16 @@ void Requester::makeRequest( ws::Request request, ws::Response::Callback respons
   d->addRequest( std::move( request ), std::move( response ) );
 }
 
+std::future<Requester::PrewarmResult> Requester::prewarm( std::vector<std::string> hosts, size_t connectionsPerHost )
+{
+  return d->prewarm( std::move( hosts ), connectionsPerHost );
+}
+
+Requester::HedgeStatistics Requester::getHedgeStatistics() const
+{
+  return { d->numHedged, d->numHedgeWins, d->numHedgesDenied };
+}
+
 static struct GlobalSetup
 {
   GlobalSetup()
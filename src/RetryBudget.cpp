@@ -0,0 +1,80 @@
+/*
+    Copyright (C) 2023  Paul Fotheringham (LinuxBrickie)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "RetryBudget.h"
+
+#include <algorithm>
+
+
+namespace lb
+{
+
+
+namespace url
+{
+
+
+// The deposit balance can never bank more than this many retries.
+static const double maxBalance{ 100.0 };
+
+
+RetryBudget::RetryBudget( double r, size_t m )
+  : ratio{ std::max( r, 0.0 ) }
+  , minRetriesPerSecond{ double( m ) }
+  , reserve{ double( m ) }
+  , lastReplenished{ Clock::now() }
+{
+}
+
+void RetryBudget::deposit()
+{
+  balance = std::min( balance + ratio, maxBalance );
+}
+
+bool RetryBudget::tryWithdraw()
+{
+  if ( balance >= 1.0 )
+  {
+    balance -= 1.0;
+    return true;
+  }
+
+  replenishReserve();
+  if ( reserve >= 1.0 )
+  {
+    reserve -= 1.0;
+    return true;
+  }
+
+  return false;
+}
+
+void RetryBudget::replenishReserve()
+{
+  const auto now{ Clock::now() };
+  const std::chrono::duration<double> elapsed{ now - lastReplenished };
+  lastReplenished = now;
+
+  reserve = std::min( reserve + elapsed.count() * minRetriesPerSecond
+                    , minRetriesPerSecond );
+}
+
+
+} // End of namespace url
+
+
+} // End of namespace lb
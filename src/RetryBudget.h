@@ -0,0 +1,79 @@
+#ifndef LIB_LB_URL_RETRYBUDGET_H
+#define LIB_LB_URL_RETRYBUDGET_H
+
+/*
+    Copyright (C) 2023  Paul Fotheringham (LinuxBrickie)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// Private header
+
+#include <chrono>
+#include <cstddef>
+
+
+namespace lb
+{
+
+
+namespace url
+{
+
+
+/** \brief Limits the number of retries a Requester makes across all requests.
+
+    Every new request deposits \a ratio of a token and every retry withdraws
+    one whole token. On top of that a reserve of \a minRetriesPerSecond tokens
+    is replenished over time so that retries are still possible at low request
+    rates. Both balances are capped so that a long run of successful requests
+    cannot bank enough tokens for a retry storm when a backend goes down.
+
+    Only ever used on the Requester thread so there is no locking.
+ */
+class RetryBudget
+{
+public:
+  RetryBudget( double ratio, size_t minRetriesPerSecond );
+
+  /** \brief Called for every new (i.e. not retried) request. */
+  void deposit();
+
+  /** \brief Called before every retry.
+      \return True if the retry can go ahead, false if the budget is exhausted.
+   */
+  bool tryWithdraw();
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  void replenishReserve();
+
+  const double ratio;
+  const double minRetriesPerSecond;
+
+  double balance{ 0.0 };
+  double reserve;
+
+  Clock::time_point lastReplenished;
+};
+
+
+} // End of namespace url
+
+
+} // End of namespace lb
+
+
+#endif // LIB_LB_URL_RETRYBUDGET_H
@@ -0,0 +1,85 @@
+/*
+    Copyright (C) 2023  Paul Fotheringham (LinuxBrickie)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "TaskQueue.h"
+
+
+namespace lb
+{
+
+
+namespace url
+{
+
+
+TaskQueue::TaskQueue( CURLM* m )
+  : multiHandle{ m }
+{
+}
+
+bool TaskQueue::post( Task task )
+{
+  std::scoped_lock l{ mutex };
+
+  if ( !multiHandle )
+  {
+    return false;
+  }
+
+  tasks.push_back( std::move( task ) );
+
+  // Holding the lock guarantees the multi handle has not been cleaned up.
+  curl_multi_wakeup( multiHandle );
+
+  return true;
+}
+
+void TaskQueue::wakeup()
+{
+  std::scoped_lock l{ mutex };
+
+  if ( multiHandle )
+  {
+    curl_multi_wakeup( multiHandle );
+  }
+}
+
+std::vector<TaskQueue::Task> TaskQueue::take()
+{
+  std::scoped_lock l{ mutex };
+
+  std::vector<Task> taken;
+  taken.swap( tasks );
+  return taken;
+}
+
+void TaskQueue::close()
+{
+  std::vector<Task> discarded;
+  {
+    std::scoped_lock l{ mutex };
+    multiHandle = nullptr;
+    discarded.swap( tasks );
+  }
+  // Tasks are destroyed outside the lock in case they hold anything that posts.
+}
+
+
+} // End of namespace url
+
+
+} // End of namespace lb
@@ -0,0 +1,85 @@
+#ifndef LIB_LB_URL_TASKQUEUE_H
+#define LIB_LB_URL_TASKQUEUE_H
+
+/*
+    Copyright (C) 2023  Paul Fotheringham (LinuxBrickie)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// Private header
+
+#include <curl/curl.h>
+
+#include <functional>
+#include <mutex>
+#include <vector>
+
+
+namespace lb
+{
+
+
+namespace url
+{
+
+
+/** \brief Work posted from any thread to be run on the Requester thread.
+
+    Posting wakes the Requester thread from curl_multi_poll so that tasks are
+    run promptly rather than after the poll timeout.
+
+    Shared with objects handed out to the request maker, such as RequestHandle,
+    which may outlive the Requester. The Requester closes the queue before it
+    cleans up the multi handle after which posting does nothing.
+ */
+class TaskQueue
+{
+public:
+  using Task = std::function< void() >;
+
+  TaskQueue( CURLM* multiHandle );
+
+  /** \brief Queue \a task and wake the Requester thread.
+      \return False if the queue has been closed and \a task discarded.
+   */
+  bool post( Task task );
+
+  /** \brief Wake the Requester thread without queueing a task, e.g. because a
+             WebSocket send has been queued for it.
+   */
+  void wakeup();
+
+  /** \brief Remove all queued tasks. Only called on the Requester thread. */
+  std::vector<Task> take();
+
+  /** \brief Discard all queued tasks and refuse any more. */
+  void close();
+
+private:
+  std::mutex mutex;
+
+  CURLM* multiHandle; //!< Null once closed. Protected by \a mutex.
+
+  std::vector<Task> tasks; //!< Protected by \a mutex.
+};
+
+
+} // End of namespace url
+
+
+} // End of namespace lb
+
+
+#endif // LIB_LB_URL_TASKQUEUE_H
@@ -0,0 +1,186 @@
+/*
+    Copyright (C) 2023  Paul Fotheringham (LinuxBrickie)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "UploadHelper.h"
+
+#include "MimeHelper.h"
+#include "http/BodyStreamImpl.h"
+
+#include <algorithm>
+#include <cstring>
+
+
+namespace lb
+{
+
+
+namespace url
+{
+
+
+UploadHelper::UploadHelper( http::Body b, const http::Request::Compression& compression )
+  : body{ std::move( b ) }
+{
+  if ( body.stream )
+  {
+    body.chunked = true;
+    readFn = &http::BodyStream::Impl::dataRead;
+    readData = http::BodyStream::Impl::get( body.stream );
+  }
+  else if ( body.dataReader.dataReadFn )
+  {
+    numBytes = body.dataReader.totalNumBytes;
+    readFn = &MimeHelper::dataRead;
+    seekFn = &MimeHelper::dataSeek;
+    readData = &body.dataReader;
+  }
+  else
+  {
+    if ( ( body.file.fd >= 0 ) || !body.file.path.empty() )
+    {
+      file = std::make_unique<FileRegion>( body.file );
+      numBytes = file->numBytes;
+      readFn = &FileRegion::dataRead;
+      seekFn = &FileRegion::dataSeek;
+      readData = file.get();
+    }
+    else
+    {
+      data = body.sharedData ? std::string_view{ *body.sharedData } : std::string_view{ body.data };
+      numBytes = data.size();
+      readFn = &dataRead;
+      seekFn = &dataSeek;
+      readData = this;
+    }
+  }
+
+  if ( !body.empty()
+    && Compressor::shouldCompress( compression, body.chunked ? std::nullopt : std::optional<size_t>{ numBytes } ) )
+  {
+    compressor = Compressor::create( compression.encoding, compression.level );
+    compressor->setSource( [this]( char* buffer, size_t n ) { return readFn( buffer, 1, n, readData ); } );
+  }
+}
+
+bool UploadHelper::setOptions( CURL* easyHandle, bool isPost )
+{
+  // The compressed size is not known up front.
+  const curl_off_t size{ ( body.chunked || compressor ) ? -1 : curl_off_t( numBytes ) };
+
+  bool ok{ true };
+  if ( compressor )
+  {
+    ok = ok && ( curl_easy_setopt( easyHandle, CURLOPT_READFUNCTION, &Compressor::dataRead ) == CURLE_OK );
+    ok = ok && ( curl_easy_setopt( easyHandle, CURLOPT_READDATA, compressor.get() ) == CURLE_OK );
+    ok = ok && ( curl_easy_setopt( easyHandle, CURLOPT_SEEKFUNCTION, &compressedSeek ) == CURLE_OK );
+    ok = ok && ( curl_easy_setopt( easyHandle, CURLOPT_SEEKDATA, this ) == CURLE_OK );
+  }
+  else
+  {
+    // Without a seek function libcurl fails the transfer if it needs to rewind.
+    ok = ok && ( curl_easy_setopt( easyHandle, CURLOPT_READFUNCTION, readFn ) == CURLE_OK );
+    ok = ok && ( curl_easy_setopt( easyHandle, CURLOPT_READDATA, readData ) == CURLE_OK );
+    if ( seekFn )
+    {
+      ok = ok && ( curl_easy_setopt( easyHandle, CURLOPT_SEEKFUNCTION, seekFn ) == CURLE_OK );
+      ok = ok && ( curl_easy_setopt( easyHandle, CURLOPT_SEEKDATA, readData ) == CURLE_OK );
+    }
+  }
+
+  if ( isPost )
+  {
+    // A size of -1 makes libcurl use chunked encoding.
+    ok = ok && ( curl_easy_setopt( easyHandle, CURLOPT_POST, 1L ) == CURLE_OK );
+    ok = ok && ( curl_easy_setopt( easyHandle, CURLOPT_POSTFIELDSIZE_LARGE, size ) == CURLE_OK );
+  }
+  else
+  {
+    // Likewise an unknown size for an HTTP/1.1 upload.
+    ok = ok && ( curl_easy_setopt( easyHandle, CURLOPT_UPLOAD, 1L ) == CURLE_OK );
+    ok = ok && ( curl_easy_setopt( easyHandle, CURLOPT_INFILESIZE_LARGE, size ) == CURLE_OK );
+  }
+
+  return ok;
+}
+
+bool UploadHelper::canRewind() const
+{
+  if ( body.stream )
+  {
+    return false;
+  }
+  return !body.dataReader.dataReadFn || body.dataReader.dataSeekFn;
+}
+
+// static
+int UploadHelper::compressedSeek( void* userData, curl_off_t offset, int origin )
+{
+  // Compressed data can only be regenerated from the start.
+  if ( ( origin != SEEK_SET ) || ( offset != 0 ) )
+  {
+    return CURL_SEEKFUNC_CANTSEEK;
+  }
+  return ((UploadHelper*)(userData))->rewind() ? CURL_SEEKFUNC_OK : CURL_SEEKFUNC_CANTSEEK;
+}
+
+void UploadHelper::bind( RequestHandle handle )
+{
+  if ( body.stream )
+  {
+    http::BodyStream::Impl::get( body.stream )->bind( std::move( handle ) );
+  }
+}
+
+bool UploadHelper::rewind()
+{
+  if ( !seekFn || ( seekFn( readData, 0, SEEK_SET ) != CURL_SEEKFUNC_OK ) )
+  {
+    return false;
+  }
+  return !compressor || compressor->reset();
+}
+
+// static
+size_t UploadHelper::dataRead( char* buffer, size_t size, size_t nitems, void* userData )
+{
+  UploadHelper& helper{ *((UploadHelper*)(userData)) };
+
+  const size_t numBytes{ std::min( size * nitems, helper.numBytes - helper.offset ) };
+  std::memcpy( buffer, helper.data.data() + helper.offset, numBytes );
+  helper.offset += numBytes;
+  return numBytes;
+}
+
+// static
+int UploadHelper::dataSeek( void* userData, curl_off_t offset, int origin )
+{
+  UploadHelper& helper{ *((UploadHelper*)(userData)) };
+
+  if ( ( origin != SEEK_SET ) || ( offset < 0 ) || ( size_t( offset ) > helper.numBytes ) )
+  {
+    return CURL_SEEKFUNC_FAIL;
+  }
+
+  helper.offset = size_t( offset );
+  return CURL_SEEKFUNC_OK;
+}
+
+
+} // End of namespace url
+
+
+} // End of namespace lb
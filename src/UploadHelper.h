@@ -0,0 +1,103 @@
+#ifndef LIB_LB_URL_UPLOADHELPER_H
+#define LIB_LB_URL_UPLOADHELPER_H
+
+/*
+    Copyright (C) 2023  Paul Fotheringham (LinuxBrickie)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// Private header
+
+#include <lb/url/RequestHandle.h>
+#include <lb/url/http/Body.h>
+
+#include "Compressor.h"
+#include "FileRegion.h"
+
+#include <curl/curl.h>
+
+#include <memory>
+#include <string_view>
+
+
+namespace lb
+{
+
+
+namespace url
+{
+
+
+/** A helper for sending an http::Body that can be used in RequestHandler subclasses. */
+struct UploadHelper
+{
+  /** \brief Throws std::runtime_error if the body is a file that cannot be used. */
+  UploadHelper( http::Body b, const http::Request::Compression& = {} );
+
+  // \a data may refer to \a body so no copying or moving.
+  UploadHelper( const UploadHelper& ) = delete;
+  UploadHelper& operator=( const UploadHelper& ) = delete;
+
+  /** \brief Set the read callback and size options.
+      \param isPost True for POST, otherwise the body is uploaded as for PUT.
+   */
+  bool setOptions( CURL*, bool isPost );
+
+  /** \brief Whether the body can be sent again from the start, e.g. for a retry. */
+  bool canRewind() const;
+
+  /** \brief Go back to the start of the body ready for it to be sent again. */
+  bool rewind();
+
+  /** \brief Allows a BodyStream to resume the transfer when written to. */
+  void bind( RequestHandle );
+
+  // C-style callbacks used by libcurl for bodies held in memory. The void* is
+  // the address of the UploadHelper. Bodies with a reader use the MimeHelper
+  // callbacks instead, and files those of FileRegion.
+  static size_t dataRead( char *buffer, size_t size, size_t nitems, void* userData );
+  static int dataSeek( void* userData, curl_off_t offset, int origin );
+
+  // Used when compressing. The void* is the address of the UploadHelper.
+  static int compressedSeek( void* userData, curl_off_t offset, int origin );
+
+  http::Body body;
+
+  // The source of the uncompressed body, selected according to the body type.
+  using ReadFunction = size_t (*)( char* buffer, size_t size, size_t nitems, void* userData );
+  using SeekFunction = int (*)( void* userData, curl_off_t offset, int origin );
+  ReadFunction readFn{ nullptr };
+  SeekFunction seekFn{ nullptr }; //!< Null if the source cannot seek.
+  void* readData{ nullptr };
+
+  std::unique_ptr<Compressor> compressor; //!< Null unless compressing.
+
+  /** \brief The body if it is in memory, either body.data or *body.sharedData. */
+  std::string_view data;
+
+  std::unique_ptr<FileRegion> file; //!< Null unless the body is body.file.
+
+  size_t numBytes{ 0 }; //!< Total size of the body before any compression.
+  size_t offset{ 0 };   //!< Next byte of \a data to be sent.
+};
+
+
+} // End of namespace url
+
+
+} // End of namespace lb
+
+
+#endif // LIB_LB_URL_UPLOADHELPER_H
@@ -0,0 +1,292 @@
+#ifndef LIB_LB_URL_URLESCAPE_H
+#define LIB_LB_URL_URLESCAPE_H
+
+/*
+    Copyright (C) 2023  Paul Fotheringham (LinuxBrickie)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// Private header
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+#if defined( __AVX2__ )
+#include <immintrin.h>
+#elif defined( __SSE2__ )
+#include <emmintrin.h>
+#endif
+
+
+namespace lb
+{
+
+
+namespace url
+{
+
+
+/** \brief Whether \a c is left as-is when URL encoding.
+
+    These are the unreserved characters of RFC 3986, the same as those that
+    curl_easy_escape leaves alone.
+ */
+inline bool isUnreserved( unsigned char c )
+{
+  return ( ( c >= 'a' ) && ( c <= 'z' ) )
+      || ( ( c >= 'A' ) && ( c <= 'Z' ) )
+      || ( ( c >= '0' ) && ( c <= '9' ) )
+      || ( c == '-' ) || ( c == '.' ) || ( c == '_' ) || ( c == '~' );
+}
+
+
+// The vectorised kernels classify a block of bytes at a time, giving a mask
+// with a bit for each byte of the block. AVX2 is only used if the library
+// is built for it, \sa the Makefile, otherwise SSE2, which all x86-64 CPUs
+// have. Other architectures use the scalar loops alone.
+#if defined( __AVX2__ )
+
+constexpr size_t escapeBlockSize{ 32 };
+constexpr uint32_t allUnreserved{ 0xFFFFFFFF };
+
+inline uint32_t unreservedMask( const char* block )
+{
+  const __m256i v{ _mm256_loadu_si256( reinterpret_cast<const __m256i*>( block ) ) };
+  auto inRange = []( __m256i x, char first, char last )
+  {
+    // Bytes of 0x80 and above are negative so are never in range.
+    return _mm256_and_si256( _mm256_cmpgt_epi8( x, _mm256_set1_epi8( first - 1 ) )
+                           , _mm256_cmpgt_epi8( _mm256_set1_epi8( last + 1 ), x ) );
+  };
+  // Setting 0x20 maps upper case letters onto lower case and no other byte
+  // onto a lower case letter.
+  const __m256i letters{ inRange( _mm256_or_si256( v, _mm256_set1_epi8( 0x20 ) ), 'a', 'z' ) };
+  const __m256i digits{ inRange( v, '0', '9' ) };
+  const __m256i hyphenOrDot{ inRange( v, '-', '.' ) };
+  const __m256i underscore{ _mm256_cmpeq_epi8( v, _mm256_set1_epi8( '_' ) ) };
+  const __m256i tilde{ _mm256_cmpeq_epi8( v, _mm256_set1_epi8( '~' ) ) };
+  const __m256i unreserved{ _mm256_or_si256( _mm256_or_si256( letters, digits )
+                                           , _mm256_or_si256( hyphenOrDot, _mm256_or_si256( underscore, tilde ) ) ) };
+  return uint32_t( _mm256_movemask_epi8( unreserved ) );
+}
+
+/** \brief A mask with a bit set for each '%' or '+', which need decoding. */
+inline uint32_t encodedMask( const char* block )
+{
+  const __m256i v{ _mm256_loadu_si256( reinterpret_cast<const __m256i*>( block ) ) };
+  return uint32_t( _mm256_movemask_epi8( _mm256_or_si256( _mm256_cmpeq_epi8( v, _mm256_set1_epi8( '%' ) )
+                                                        , _mm256_cmpeq_epi8( v, _mm256_set1_epi8( '+' ) ) ) ) );
+}
+
+#elif defined( __SSE2__ )
+
+constexpr size_t escapeBlockSize{ 16 };
+constexpr uint32_t allUnreserved{ 0xFFFF };
+
+inline uint32_t unreservedMask( const char* block )
+{
+  const __m128i v{ _mm_loadu_si128( reinterpret_cast<const __m128i*>( block ) ) };
+  auto inRange = []( __m128i x, char first, char last )
+  {
+    // Bytes of 0x80 and above are negative so are never in range.
+    return _mm_and_si128( _mm_cmpgt_epi8( x, _mm_set1_epi8( first - 1 ) )
+                        , _mm_cmplt_epi8( x, _mm_set1_epi8( last + 1 ) ) );
+  };
+  // Setting 0x20 maps upper case letters onto lower case and no other byte
+  // onto a lower case letter.
+  const __m128i letters{ inRange( _mm_or_si128( v, _mm_set1_epi8( 0x20 ) ), 'a', 'z' ) };
+  const __m128i digits{ inRange( v, '0', '9' ) };
+  const __m128i hyphenOrDot{ inRange( v, '-', '.' ) };
+  const __m128i underscore{ _mm_cmpeq_epi8( v, _mm_set1_epi8( '_' ) ) };
+  const __m128i tilde{ _mm_cmpeq_epi8( v, _mm_set1_epi8( '~' ) ) };
+  const __m128i unreserved{ _mm_or_si128( _mm_or_si128( letters, digits )
+                                        , _mm_or_si128( hyphenOrDot, _mm_or_si128( underscore, tilde ) ) ) };
+  return uint32_t( _mm_movemask_epi8( unreserved ) );
+}
+
+/** \brief A mask with a bit set for each '%' or '+', which need decoding. */
+inline uint32_t encodedMask( const char* block )
+{
+  const __m128i v{ _mm_loadu_si128( reinterpret_cast<const __m128i*>( block ) ) };
+  return uint32_t( _mm_movemask_epi8( _mm_or_si128( _mm_cmpeq_epi8( v, _mm_set1_epi8( '%' ) )
+                                                  , _mm_cmpeq_epi8( v, _mm_set1_epi8( '+' ) ) ) ) );
+}
+
+#endif
+
+
+/** \brief The number of leading bytes of \a s that are unreserved. */
+inline size_t unreservedPrefixSize( std::string_view s )
+{
+  size_t i{ 0 };
+#if defined( __AVX2__ ) || defined( __SSE2__ )
+  for ( ; i + escapeBlockSize <= s.size(); i += escapeBlockSize )
+  {
+    const uint32_t mask{ unreservedMask( s.data() + i ) };
+    if ( mask != allUnreserved )
+    {
+      return i + __builtin_ctz( ~mask );
+    }
+  }
+#endif
+  while ( ( i < s.size() ) && isUnreserved( s[ i ] ) )
+  {
+    ++i;
+  }
+  return i;
+}
+
+/** \brief The number of bytes \a s takes once URL encoded. */
+inline size_t escapedSize( std::string_view s )
+{
+  size_t numReserved{ 0 };
+  size_t i{ 0 };
+#if defined( __AVX2__ ) || defined( __SSE2__ )
+  for ( ; i + escapeBlockSize <= s.size(); i += escapeBlockSize )
+  {
+    numReserved += __builtin_popcount( ~unreservedMask( s.data() + i ) & allUnreserved );
+  }
+#endif
+  for ( ; i < s.size(); ++i )
+  {
+    if ( !isUnreserved( s[ i ] ) )
+    {
+      ++numReserved;
+    }
+  }
+  return s.size() + 2 * numReserved;
+}
+
+/** \brief URL encode \a s into \a out, which must have escapedSize( s ) bytes.
+    \return The end of the encoded data.
+
+    Runs of unreserved bytes are found a block at a time and copied in one go.
+ */
+inline char* escape( std::string_view s, char* out )
+{
+  static constexpr char hexDigits[]{ "0123456789ABCDEF" };
+
+  while ( !s.empty() )
+  {
+    const size_t numUnreserved{ unreservedPrefixSize( s ) };
+    std::memcpy( out, s.data(), numUnreserved );
+    out += numUnreserved;
+    s.remove_prefix( numUnreserved );
+
+    while ( !s.empty() && !isUnreserved( s.front() ) )
+    {
+      const unsigned char u( s.front() );
+      *out++ = '%';
+      *out++ = hexDigits[ u >> 4 ];
+      *out++ = hexDigits[ u & 0x0F ];
+      s.remove_prefix( 1 );
+    }
+  }
+  return out;
+}
+
+
+/** \brief The value of hex digit \a c or -1 if it is not one. */
+inline int hexValue( char c )
+{
+  if ( ( c >= '0' ) && ( c <= '9' ) )
+  {
+    return c - '0';
+  }
+  if ( ( c >= 'A' ) && ( c <= 'F' ) )
+  {
+    return c - 'A' + 10;
+  }
+  if ( ( c >= 'a' ) && ( c <= 'f' ) )
+  {
+    return c - 'a' + 10;
+  }
+  return -1;
+}
+
+/** \brief The number of leading bytes of \a s that need no decoding. */
+inline size_t decodedPrefixSize( std::string_view s )
+{
+  size_t i{ 0 };
+#if defined( __AVX2__ ) || defined( __SSE2__ )
+  for ( ; i + escapeBlockSize <= s.size(); i += escapeBlockSize )
+  {
+    if ( const uint32_t mask{ encodedMask( s.data() + i ) } )
+    {
+      return i + __builtin_ctz( mask );
+    }
+  }
+#endif
+  while ( ( i < s.size() ) && ( s[ i ] != '%' ) && ( s[ i ] != '+' ) )
+  {
+    ++i;
+  }
+  return i;
+}
+
+/** \brief Decode URL encoded \a s into \a out, which may be s.data().
+    \return The end of the decoded data.
+
+    '+' is decoded as a space as in form data. A '%' that is not followed by
+    two hex digits is left as-is. Runs of bytes that need no decoding are found
+    a block at a time and moved in one go.
+ */
+inline char* unescape( std::string_view s, char* out )
+{
+  while ( !s.empty() )
+  {
+    const size_t numPlain{ decodedPrefixSize( s ) };
+    if ( out != s.data() )
+    {
+      std::memmove( out, s.data(), numPlain );
+    }
+    out += numPlain;
+    s.remove_prefix( numPlain );
+
+    if ( s.empty() )
+    {
+      break;
+    }
+
+    int high, low;
+    if ( s.front() == '+' )
+    {
+      *out++ = ' ';
+      s.remove_prefix( 1 );
+    }
+    else if ( ( s.size() >= 3 ) && ( ( high = hexValue( s[ 1 ] ) ) >= 0 ) && ( ( low = hexValue( s[ 2 ] ) ) >= 0 ) )
+    {
+      *out++ = char( ( high << 4 ) | low );
+      s.remove_prefix( 3 );
+    }
+    else
+    {
+      *out++ = '%';
+      s.remove_prefix( 1 );
+    }
+  }
+  return out;
+}
+
+
+} // End of namespace url
+
+
+} // End of namespace lb
+
+
+#endif // LIB_LB_URL_URLESCAPE_H
@@ -0,0 +1,72 @@
+/*
+    Copyright (C) 2023  Paul Fotheringham (LinuxBrickie)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <lb/url/UrlTemplate.h>
+
+#include "UrlEscape.h"
+
+#include <cstring>
+
+
+namespace lb
+{
+
+
+namespace url
+{
+
+
+static char* copy( std::string_view s, char* out )
+{
+  std::memcpy( out, s.data(), s.size() );
+  return out + s.size();
+}
+
+
+std::string UrlTemplate::substitute( const Argument* arguments, size_t numArguments ) const
+{
+  if ( numArguments != numNames )
+  {
+    throw std::runtime_error( "URL template has " + std::to_string( numNames )
+                            + " placeholders but " + std::to_string( numArguments ) + " arguments" );
+  }
+
+  size_t numBytes{ literalsNumBytes };
+  for ( size_t i = 0; i < numArguments; ++i )
+  {
+    const Argument& argument{ arguments[ i ] };
+    numBytes += argument.needsEncoded ? escapedSize( argument.text ) : argument.text.size();
+  }
+
+  std::string url( numBytes, '\0' );
+  char* out{ url.data() };
+  out = copy( literals[ 0 ], out );
+  for ( size_t i = 0; i < numArguments; ++i )
+  {
+    const Argument& argument{ arguments[ i ] };
+    out = argument.needsEncoded ? escape( argument.text, out ) : copy( argument.text, out );
+    out = copy( literals[ i + 1 ], out );
+  }
+
+  return url;
+}
+
+
+} // End of namespace url
+
+
+} // End of namespace lb
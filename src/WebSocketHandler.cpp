@@ -20,6 +20,7 @@
 
 #include <lb/encoding/websocket.h>
 
+#include <algorithm>
 #include <iostream>
 
 
@@ -34,12 +35,20 @@ namespace url
 // Library-wide counter i.e. shared by all Requester instances effectively.
 ws::ConnectionID globalConnectionID{ 0 };
 
+//! Enough for any control frame to be read in one go.
+static const size_t minReceiveBufferSize{ 125 };
+
+//! The most reserved for a frame on the strength of its advertised size alone.
+static const size_t maxReserveNumBytes{ 16 * 1024 * 1024 };
+
 
 WebSocketHandler::WebSocketHandler( ws::Request r
-                                  , ws::Response::Callback c )
+                                  , ws::Response::Callback c
+                                  , std::shared_ptr<TaskQueue> t )
   : connectionID{ globalConnectionID++ }
   , request{ std::move( r ) }
   , responseCallback{ std::move( c ) }
+  , tasks{ std::move( t ) }
 {
   curl_easy_setopt( easyHandle, CURLOPT_HTTPGET, 1L );
   curl_easy_setopt( easyHandle, CURLOPT_URL, request.url.c_str() );
@@ -77,17 +86,21 @@ RequestHandler::Status WebSocketHandler::respond( ResponseCode rc
                      , this
                      , std::placeholders::_1
                      , std::placeholders::_2
-                     , std::placeholders::_3 ),
+                     , std::placeholders::_3
+                     , std::placeholders::_4 ),
             std::bind( &WebSocketHandler::queueSendClose
                      , this
                      , std::placeholders::_1,
-                       std::placeholders::_2 ),
+                       std::placeholders::_2,
+                       std::placeholders::_3 ),
             std::bind( &WebSocketHandler::queueSendPing
                      , this
-                     , std::placeholders::_1 ),
+                     , std::placeholders::_1
+                     , std::placeholders::_2 ),
             std::bind( &WebSocketHandler::queueSendPong
                      , this
-                     , std::placeholders::_1 ) );
+                     , std::placeholders::_1
+                     , std::placeholders::_2 ) );
 
         responseCallback( ResponseCode::eSuccess
                         , {
@@ -144,7 +157,9 @@ bool WebSocketHandler::update()
     return false;
   }
 
-  if ( !receive() )
+  // Only read when the Requester's poll found data, or could not tell, so that
+  // idle connections cost nothing.
+  if ( readable && !receive() )
   {
     ws::Senders::Impl::close( senders );
     discardPendingSends();
@@ -176,13 +191,19 @@ bool WebSocketHandler::close()
 
 void WebSocketHandler::processPendingSends()
 {
-  std::scoped_lock l{ pendingSendMutex };
+  // Take the sends so that the lock is not held whilst completing them. A
+  // callback may well queue another send.
+  std::vector<PendingSend> sends;
+  {
+    std::scoped_lock l{ pendingSendMutex };
+    sends.swap( pendingSends );
+  }
 
-  for ( auto& pendingSend : pendingSends )
+  for ( auto& pendingSend : sends )
   {
     if ( pendingSend.dataOpCode )
     {
-      pendingSend.sendResultPromise.set_value(
+      pendingSend.complete(
         sendData( *pendingSend.dataOpCode
                 , pendingSend.s
                 , pendingSend.maxFrameSize ) );
@@ -192,16 +213,16 @@ void WebSocketHandler::processPendingSends()
       switch( *pendingSend.controlOpCode )
       {
       case ws::ControlOpCode::eClose:
-        pendingSend.sendResultPromise.set_value(
+        pendingSend.complete(
           sendClose( pendingSend.closePayloadCode
                    , pendingSend.s ) );
         break;
       case ws::ControlOpCode::ePing:
-        pendingSend.sendResultPromise.set_value(
+        pendingSend.complete(
           sendPing( pendingSend.s ) );
         break;
       case ws::ControlOpCode::ePong:
-        pendingSend.sendResultPromise.set_value(
+        pendingSend.complete(
           sendPong( pendingSend.s ) );
       }
     }
@@ -210,8 +231,6 @@ void WebSocketHandler::processPendingSends()
       std::cerr << "Invalid pending send. Ignoring." << std::endl;
     }
   }
-
-  pendingSends.clear();
 }
 
 bool WebSocketHandler::maybeAdvanceCloseHandshake()
@@ -266,28 +285,21 @@ bool WebSocketHandler::maybeAdvanceCloseHandshake()
   return true;
 }
 
-void WebSocketHandler::processFrame( const curl_ws_frame& meta
+void WebSocketHandler::processFrame( int flags
                                    , const std::string& payload )
 {
   // Assumes mutex is locked
 
-  if ( meta.flags & CURLWS_TEXT )
+  if ( flags & CURLWS_TEXT )
   {
-    //if ( FIN bit set )
-    //{
     if ( !request.receivers.receiveData( connectionID
                                        , ws::DataOpCode::eText
                                        , payload ) )
     {
       std::cout << "Receiver no longer receiving data." << std::endl;
     }
-    //}
-    //else
-    //{
-    //  receivedMessage.append( message, numMessageBytes );
-    //}
   }
-  else if ( meta.flags & CURLWS_BINARY )
+  else if ( flags & CURLWS_BINARY )
   {
     // In practice they may be supported, just not tested. TODO
     std::cerr << "Binary frames not yet supported!" << std::endl;
@@ -296,22 +308,7 @@ void WebSocketHandler::processFrame( const curl_ws_frame& meta
                  encoding::websocket::closestatus::ProtocolCode::eUnacceptableData )
              , "Cannot send binary data (yet)." );
   }
-  else if ( meta.flags & CURLWS_CONT )
-  {
-    receivedMessage.append( payload );
-    //if ( FIN bit set )
-    //{
-    //  std::string data;
-    //  data.swap( receivedMessage );
-    //  if ( !request.receivers.receiveData( connectionID
-    //                                     , ws::DataOpCode::eText
-    //                                     , std::move( data ) ) )
-    //  {
-    //    std::cout << "Receiver no longer receiving data." << std::endl;
-    //  }
-    //}
-  }
-  else if ( meta.flags & CURLWS_CLOSE )
+  else if ( flags & CURLWS_CLOSE )
   {
     //std::cout << "   received CLOSE" << std::endl;
 
@@ -360,7 +357,7 @@ void WebSocketHandler::processFrame( const curl_ws_frame& meta
       break;
     }
   }
-  else if ( meta.flags & CURLWS_PING )
+  else if ( flags & CURLWS_PING )
   {
     //std::cout << "Received PING frame!" << std::endl;
 
@@ -373,7 +370,7 @@ void WebSocketHandler::processFrame( const curl_ws_frame& meta
 
     sendPong( payload );
   }
-  else if ( meta.flags & CURLWS_PONG )
+  else if ( flags & CURLWS_PONG )
   {
     if ( awaitingPong )
     {
@@ -393,50 +390,60 @@ void WebSocketHandler::processFrame( const curl_ws_frame& meta
   }
 }
 
+/** \brief True if \a flags are those of a control frame. */
+static bool isControl( int flags )
+{
+  return flags & ( CURLWS_CLOSE | CURLWS_PING | CURLWS_PONG );
+}
+
 bool WebSocketHandler::receive()
 {
   // Assumes mutex is locked
 
-  // May not receive a full message, only a frame. If the message fits in the
-  // one frame then we dispatch it right away, otherwise it gets built up in
-  // receivedMessage and dispatched on the last frame.
+  // A message may be split across several frames and a frame across several
+  // reads so it builds up in receivedMessage and is dispatched once the last
+  // frame is complete. The start of each frame is read into receiveBuffer, as
+  // its size is not yet known, but once it is the buffer for the message is
+  // grown to fit and the rest of the frame is read straight into it.
   //
-  // We might not even get a full frame. We have to keep calling curl_ws_recv
-  // until either the number of bytes received is less than the buffer size or
-  // we get CURLE_GOT_NOTHING.
-  const curl_ws_frame* meta{ nullptr };
-  std::string frame;
-  bool frameIncomplete{ true };
+  // Every frame that has arrived is processed, until CURLE_AGAIN, as libcurl
+  // may already hold further frames in its own buffer and the socket will not
+  // poll as readable again for those.
+  const size_t bufferSize{ std::max( request.receiveBufferSize, minReceiveBufferSize ) };
+  receiveBuffer.resize( bufferSize );
 
-  int loop = 0;
-  while( frameIncomplete )
+  while ( closeHandshake != CloseHandshake::eComplete )
   {
-    size_t numBytesReceived;
-    const size_t BUFFER_SIZE{ 256 };
-    char buffer[ BUFFER_SIZE ];
+    const bool direct{ ( frameNumBytesLeft > 0 ) && !isControl( frameFlags ) };
+    const size_t numBytesToRead{ direct ? std::min( frameNumBytesLeft, bufferSize ) : bufferSize };
+    const size_t offset{ receivedMessage.size() };
+    if ( direct )
+    {
+      receivedMessage.resize( offset + numBytesToRead );
+    }
 
-    const CURLcode result = curl_ws_recv( easyHandle, buffer, sizeof(buffer), &numBytesReceived, &meta );
+    size_t numBytesReceived{ 0 };
+    const curl_ws_frame* meta{ nullptr };
+    const CURLcode result = curl_ws_recv( easyHandle
+                                        , direct ? receivedMessage.data() + offset : receiveBuffer.data()
+                                        , numBytesToRead
+                                        , &numBytesReceived
+                                        , &meta );
+    if ( direct )
+    {
+      receivedMessage.resize( offset + ( result == CURLE_OK ? numBytesReceived : 0 ) );
+    }
 
     switch( result )
     {
     case CURLE_OK:
-    {
-      //std::cout << request.url << "  " << loop << " :CURLE_OK: " << numBytesReceived << " bytes." << std::endl;
-
-      frame.append( buffer, numBytesReceived );
-      if ( numBytesReceived < BUFFER_SIZE )
-      {
-        frameIncomplete = false;
-      }
       break;
-    }
     case CURLE_GOT_NOTHING:
       // This means the connection is closed.
-      //std::cout << request.url << "  " << loop << " :CURLE_GOT_NOTHING" << std::endl;
       return false;
     case CURLE_AGAIN:
-      //std::cout << request.url << "  " << loop << " :CURLE_EAGAIN" << std::endl;
-      // Fine, just means there is no data to receive.
+      // Fine, just means there is no more data to receive. Anything received
+      // so far is kept until the rest arrives.
       return true;
     default:
       ws::Senders::Impl::close( senders );
@@ -444,14 +451,39 @@ bool WebSocketHandler::receive()
       return false;
     }
 
-    ++loop;
-  }
+    frameFlags = meta->flags;
+    frameNumBytesLeft = size_t( meta->bytesleft );
 
-  if ( meta )
-  {
-    std::cout << "META Offset: " << meta->offset << ", bytes left: " << meta->bytesleft << std::endl;
+    if ( isControl( frameFlags ) )
+    {
+      // Control frames may arrive between the frames of a fragmented message
+      // so are kept apart from it. They are never more than 125 bytes.
+      receivedControl.append( receiveBuffer.data(), numBytesReceived );
+      if ( frameNumBytesLeft == 0 )
+      {
+        processFrame( frameFlags, receivedControl );
+        receivedControl.clear();
+      }
+      continue;
+    }
+
+    if ( !direct )
+    {
+      receivedMessage.append( receiveBuffer.data(), numBytesReceived );
+    }
 
-    processFrame( *meta, frame );
+    if ( frameNumBytesLeft > 0 )
+    {
+      // Only trust the advertised size so far, larger frames grow the buffer
+      // as the data actually arrives.
+      receivedMessage.reserve( receivedMessage.size() + std::min( frameNumBytesLeft, maxReserveNumBytes ) );
+    }
+    else if ( !( frameFlags & CURLWS_CONT ) )
+    {
+      // The last frame of the message. Clearing keeps the capacity for the next.
+      processFrame( frameFlags, receivedMessage );
+      receivedMessage.clear();
+    }
   }
 
   return true;
@@ -459,26 +491,40 @@ bool WebSocketHandler::receive()
 
 void WebSocketHandler::discardPendingSends()
 {
-  std::scoped_lock l{ pendingSendMutex };
+  std::vector<PendingSend> sends;
+  {
+    std::scoped_lock l{ pendingSendMutex };
+    sends.swap( pendingSends );
+  }
 
-  for ( auto& pendingSend : pendingSends )
+  for ( auto& pendingSend : sends )
   {
-    pendingSend.sendResultPromise.set_value( ws::SendResult::eClosed );
+    pendingSend.complete( ws::SendResult::eClosed );
   }
+}
 
-  pendingSends.clear();
+void WebSocketHandler::PendingSend::complete( ws::SendResult result )
+{
+  if ( callback )
+  {
+    callback( result );
+  }
+  else
+  {
+    sendResultPromise.set_value( result );
+  }
 }
 
-std::future<ws::SendResult> WebSocketHandler::queueSendData( ws::DataOpCode opCode
-                                                           , const std::string& message
-                                                           , size_t maxFrameSize )
+std::optional< std::future<ws::SendResult> >
+WebSocketHandler::queueSendData( ws::DataOpCode opCode
+                               , const std::string& message
+                               , size_t maxFrameSize
+                               , ws::Senders::Callback& callback )
 {
   // Should not be necessary as we close the Senders::Impl but does no harm.
   if ( closeHandshake != CloseHandshake::eNone )
   {
-    std::promise<ws::SendResult> promise;
-    promise.set_value( ws::SendResult::eClosed );
-    return promise.get_future();
+    return std::nullopt;
   }
 
   std::scoped_lock psl{ pendingSendMutex };
@@ -488,23 +534,31 @@ std::future<ws::SendResult> WebSocketHandler::queueSendData( ws::DataOpCode opCo
   pendingSend.s = message;
   pendingSend.maxFrameSize = maxFrameSize;
 
-  auto future{ pendingSend.sendResultPromise.get_future() };
+  std::future<ws::SendResult> future;
+  if ( callback )
+  {
+    pendingSend.callback = std::move( callback );
+  }
+  else
+  {
+    future = pendingSend.sendResultPromise.get_future();
+  }
 
   pendingSends.emplace_back( std::move( pendingSend ) );
+  tasks->wakeup();
 
   return future;
 }
 
-std::future<ws::SendResult>
+std::optional< std::future<ws::SendResult> >
 WebSocketHandler::queueSendClose( encoding::websocket::closestatus::PayloadCode code
-                                , const std::string& reason )
+                                , const std::string& reason
+                                , ws::Senders::Callback& callback )
 {
   // Should not be necessary as we close the Senders::Impl but does no harm.
   if ( closeHandshake != CloseHandshake::eNone )
   {
-    std::promise<ws::SendResult> promise;
-    promise.set_value( ws::SendResult::eClosed );
-    return promise.get_future();
+    return std::nullopt;
   }
 
   std::scoped_lock psl{ pendingSendMutex };
@@ -514,22 +568,29 @@ WebSocketHandler::queueSendClose( encoding::websocket::closestatus::PayloadCode
   pendingSend.closePayloadCode = code;
   pendingSend.s = reason;
 
-  auto future{ pendingSend.sendResultPromise.get_future() };
+  std::future<ws::SendResult> future;
+  if ( callback )
+  {
+    pendingSend.callback = std::move( callback );
+  }
+  else
+  {
+    future = pendingSend.sendResultPromise.get_future();
+  }
 
   pendingSends.emplace_back( std::move( pendingSend ) );
+  tasks->wakeup();
 
   return future;
 }
 
-std::future<ws::SendResult>
-WebSocketHandler::queueSendPing( const std::string &payload )
+std::optional< std::future<ws::SendResult> >
+WebSocketHandler::queueSendPing( const std::string &payload, ws::Senders::Callback& callback )
 {
   // Should not be necessary as we close the Senders::Impl but does no harm.
   if ( closeHandshake != CloseHandshake::eNone )
   {
-    std::promise<ws::SendResult> promise;
-    promise.set_value( ws::SendResult::eClosed );
-    return promise.get_future();
+    return std::nullopt;
   }
 
   std::scoped_lock psl{ pendingSendMutex };
@@ -538,22 +599,29 @@ WebSocketHandler::queueSendPing( const std::string &payload )
   pendingSend.controlOpCode = ws::ControlOpCode::ePing;
   pendingSend.s = payload;
 
-  auto future{ pendingSend.sendResultPromise.get_future() };
+  std::future<ws::SendResult> future;
+  if ( callback )
+  {
+    pendingSend.callback = std::move( callback );
+  }
+  else
+  {
+    future = pendingSend.sendResultPromise.get_future();
+  }
 
   pendingSends.emplace_back( std::move( pendingSend ) );
+  tasks->wakeup();
 
   return future;
 }
 
-std::future<ws::SendResult>
-WebSocketHandler::queueSendPong( const std::string &payload )
+std::optional< std::future<ws::SendResult> >
+WebSocketHandler::queueSendPong( const std::string &payload, ws::Senders::Callback& callback )
 {
   // Should not be necessary as we close the Senders::Impl but does no harm.
   if ( closeHandshake != CloseHandshake::eNone )
   {
-    std::promise<ws::SendResult> promise;
-    promise.set_value( ws::SendResult::eClosed );
-    return promise.get_future();
+    return std::nullopt;
   }
 
   std::scoped_lock psl{ pendingSendMutex };
@@ -562,9 +630,18 @@ WebSocketHandler::queueSendPong( const std::string &payload )
   pendingSend.controlOpCode = ws::ControlOpCode::ePong;
   pendingSend.s = payload;
 
-  auto future{ pendingSend.sendResultPromise.get_future() };
+  std::future<ws::SendResult> future;
+  if ( callback )
+  {
+    pendingSend.callback = std::move( callback );
+  }
+  else
+  {
+    future = pendingSend.sendResultPromise.get_future();
+  }
 
   pendingSends.emplace_back( std::move( pendingSend ) );
+  tasks->wakeup();
 
   return future;
 }
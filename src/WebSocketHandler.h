@@ -26,11 +26,14 @@
 #include <lb/url/ws/Senders.h>
 
 #include "RequestHandler.h"
+#include "TaskQueue.h"
 
 #include <atomic>
 #include <chrono>
 #include <memory>
 #include <mutex>
+#include <optional>
+#include <vector>
 
 
 namespace lb
@@ -60,13 +63,18 @@ namespace url
     for an arbitrary length of time this handler typically sticks around for a
     lot longer than others.
 
-    The handler will poll for data when \a update() is called.
+    The handler reads data when \a update() is called, but only once the
+    \a Requester has polled the socket as readable.
 */
 class WebSocketHandler : public RequestHandler
 {
 public:
+  /** \a tasks is woken whenever a send is queued so that the Requester
+      thread dispatches it without waiting for the poll to time out.
+   */
   WebSocketHandler( ws::Request r
-                  , ws::Response::Callback c );
+                  , ws::Response::Callback c
+                  , std::shared_ptr<TaskQueue> tasks );
   ~WebSocketHandler();
 
   virtual Status respond( ResponseCode, std::string );
@@ -96,20 +104,23 @@ public:
 private:
   void processPendingSends();
   bool maybeAdvanceCloseHandshake();
-  void processFrame( const curl_ws_frame& meta, const std::string& frame );
+  void processFrame( int flags, const std::string& payload );
   bool receive();
   void discardPendingSends();
 
   // Note that these send methods are all bound to the \a senders object that
   // is passed back outside this instance. Calls to these may therefore be made
-  // asynchronously to the public API.
-  std::future<ws::SendResult> queueSendData( ws::DataOpCode
-                                           , const std::string&
-                                           , size_t maxFrameSize );
-  std::future<ws::SendResult> queueSendClose( encoding::websocket::closestatus::PayloadCode code
-                                            , const std::string& reason );
-  std::future<ws::SendResult> queueSendPing( const std::string& payload );
-  std::future<ws::SendResult> queueSendPong( const std::string& payload );
+  // asynchronously to the public API. See Senders::Impl::DataSender for the
+  // return value and callback.
+  std::optional< std::future<ws::SendResult> > queueSendData( ws::DataOpCode
+                                                            , const std::string&
+                                                            , size_t maxFrameSize
+                                                            , ws::Senders::Callback& );
+  std::optional< std::future<ws::SendResult> > queueSendClose( encoding::websocket::closestatus::PayloadCode code
+                                                             , const std::string& reason
+                                                             , ws::Senders::Callback& );
+  std::optional< std::future<ws::SendResult> > queueSendPing( const std::string& payload, ws::Senders::Callback& );
+  std::optional< std::future<ws::SendResult> > queueSendPong( const std::string& payload, ws::Senders::Callback& );
 
   ws::SendResult sendData( ws::DataOpCode, const std::string&, size_t maxFrameSize );
   ws::SendResult sendClose( encoding::websocket::closestatus::PayloadCode code
@@ -117,10 +128,11 @@ private:
   ws::SendResult sendPing( const std::string& payload );
   ws::SendResult sendPong( const std::string& payload );
 
-  // These three require no mutex protection.
+  // These four require no mutex protection.
   ws::ConnectionID connectionID;
   ws::Request request;
   ws::Response::Callback responseCallback;
+  const std::shared_ptr<TaskQueue> tasks;
 
   // Mutex to protect concurrent access to all remanining members.
   std::recursive_mutex mutex;
@@ -130,9 +142,21 @@ private:
   // away.
   ws::Senders senders;
 
-  //! THe message currently being received (if split across multiple frames)
+  //! The message currently being received. Kept between messages so that
+  //! once it has grown to fit nothing is allocated.
   std::string receivedMessage;
 
+  //! Where the start of each frame is read, \sa ws::Request::receiveBufferSize
+  std::vector<char> receiveBuffer;
+
+  //! The flags and bytes not yet read of the current frame, \sa curl_ws_frame
+  int frameFlags{ 0 };
+  size_t frameNumBytesLeft{ 0 };
+
+  //! The control frame currently being received, kept apart from
+  //! \a receivedMessage as it may arrive between the frames of a message.
+  std::string receivedControl;
+
   // Note that there is no transition from eSergverInitiated to eComplete as we
   // have no way to detect it. They are, effectively, the same state.
   enum class CloseHandshake
@@ -158,7 +182,11 @@ private:
 
   struct PendingSend
   {
+    //! The result goes to \a callback if set, otherwise to the promise.
     std::promise<ws::SendResult> sendResultPromise;
+    ws::Senders::Callback callback;
+
+    void complete( ws::SendResult );
 
     // One and only one of these is ever set.
     std::optional<ws::DataOpCode> dataOpCode;
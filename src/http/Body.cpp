@@ -0,0 +1,66 @@
+/*
+    Copyright (C) 2023  Paul Fotheringham (LinuxBrickie)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <lb/url/http/Body.h>
+
+
+namespace lb
+{
+
+
+namespace url
+{
+
+
+namespace http
+{
+
+
+bool Body::empty() const
+{
+  return !stream && !dataReader.dataReadFn && ( file.fd < 0 ) && file.path.empty() && !sharedData && data.empty();
+}
+
+size_t Body::size() const
+{
+  if ( stream )
+  {
+    return 0;
+  }
+  if ( dataReader.dataReadFn )
+  {
+    return dataReader.totalNumBytes;
+  }
+  if ( ( file.fd >= 0 ) || !file.path.empty() )
+  {
+    return file.numBytes;
+  }
+  if ( sharedData )
+  {
+    return sharedData->size();
+  }
+  return data.size();
+}
+
+
+} // End of namespace http
+
+
+} // End of namespace url
+
+
+} // End of namespace lb
@@ -0,0 +1,198 @@
+/*
+    Copyright (C) 2023  Paul Fotheringham (LinuxBrickie)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <lb/url/http/BodyStream.h>
+
+#include "BodyStreamImpl.h"
+
+#include <curl/curl.h>
+
+#include <algorithm>
+#include <cstring>
+
+
+namespace lb
+{
+
+
+namespace url
+{
+
+
+namespace http
+{
+
+
+// static
+BodyStream BodyStream::create()
+{
+  BodyStream stream;
+  stream.d = std::make_shared<Impl>();
+  return stream;
+}
+
+BodyStream::operator bool() const
+{
+  return bool( d );
+}
+
+bool BodyStream::write( std::string data ) const
+{
+  return d && d->write( std::move( data ) );
+}
+
+void BodyStream::finish() const
+{
+  if ( d )
+  {
+    d->finish();
+  }
+}
+
+void BodyStream::abort() const
+{
+  if ( d )
+  {
+    d->abort();
+  }
+}
+
+size_t BodyStream::numBufferedBytes() const
+{
+  return d ? d->numBufferedBytes() : 0;
+}
+
+
+void BodyStream::Impl::bind( RequestHandle h )
+{
+  std::scoped_lock l{ mutex };
+  handle = std::move( h );
+}
+
+bool BodyStream::Impl::write( std::string data )
+{
+  RequestHandle toResume;
+  {
+    std::scoped_lock l{ mutex };
+    if ( finished || aborted )
+    {
+      return false;
+    }
+    if ( data.empty() )
+    {
+      return true;
+    }
+
+    numBuffered += data.size();
+    chunks.push_back( std::move( data ) );
+
+    if ( paused )
+    {
+      paused = false;
+      toResume = handle;
+    }
+  }
+
+  // Outside the lock as resuming may be immediate if on the Requester thread.
+  toResume.resume();
+  return true;
+}
+
+void BodyStream::Impl::finish()
+{
+  RequestHandle toResume;
+  {
+    std::scoped_lock l{ mutex };
+    finished = true;
+    if ( paused )
+    {
+      paused = false;
+      toResume = handle;
+    }
+  }
+  toResume.resume();
+}
+
+void BodyStream::Impl::abort()
+{
+  RequestHandle toResume;
+  {
+    std::scoped_lock l{ mutex };
+    aborted = true;
+    if ( paused )
+    {
+      paused = false;
+      toResume = handle;
+    }
+  }
+  toResume.resume();
+}
+
+size_t BodyStream::Impl::numBufferedBytes() const
+{
+  std::scoped_lock l{ mutex };
+  return numBuffered;
+}
+
+size_t BodyStream::Impl::read( char* buffer, size_t numBytes )
+{
+  std::scoped_lock l{ mutex };
+
+  if ( aborted )
+  {
+    return CURL_READFUNC_ABORT;
+  }
+
+  size_t numRead{ 0 };
+  while ( ( numRead < numBytes ) && !chunks.empty() )
+  {
+    const std::string& chunk{ chunks.front() };
+    const size_t n{ std::min( numBytes - numRead, chunk.size() - frontOffset ) };
+    std::memcpy( buffer + numRead, chunk.data() + frontOffset, n );
+    numRead += n;
+    frontOffset += n;
+    if ( frontOffset == chunk.size() )
+    {
+      chunks.pop_front();
+      frontOffset = 0;
+    }
+  }
+  numBuffered -= numRead;
+
+  if ( ( numRead == 0 ) && !finished )
+  {
+    paused = true;
+    return CURL_READFUNC_PAUSE;
+  }
+
+  return numRead;
+}
+
+// static
+size_t BodyStream::Impl::dataRead( char* buffer, size_t size, size_t nitems, void* userData )
+{
+  return ((BodyStream::Impl*)(userData))->read( buffer, size * nitems );
+}
+
+
+} // End of namespace http
+
+
+} // End of namespace url
+
+
+} // End of namespace lb
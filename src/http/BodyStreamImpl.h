@@ -0,0 +1,95 @@
+#ifndef LIB_LB_URL_HTTP_BODYSTREAMIMPL_H
+#define LIB_LB_URL_HTTP_BODYSTREAMIMPL_H
+
+/*
+    Copyright (C) 2023  Paul Fotheringham (LinuxBrickie)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// Private header
+
+#include <lb/url/RequestHandle.h>
+#include <lb/url/http/BodyStream.h>
+
+#include <deque>
+#include <mutex>
+#include <string>
+
+
+namespace lb
+{
+
+
+namespace url
+{
+
+
+namespace http
+{
+
+
+struct BodyStream::Impl
+{
+  static Impl* get( const BodyStream& stream )
+  {
+    return stream.d.get();
+  }
+
+  /** \brief Called by Requester::makeRequest, on the submitting thread,
+             before the request is queued.
+
+      \a handle is used to resume the transfer once more data is written.
+      Writes may already be happening on other threads hence the locking.
+   */
+  void bind( RequestHandle handle );
+
+  bool write( std::string data );
+  void finish();
+  void abort();
+  size_t numBufferedBytes() const;
+
+  /** \brief Fill \a buffer for libcurl's read callback.
+      \return The number of bytes read, zero at the end of the body,
+              CURL_READFUNC_PAUSE if waiting for more data or
+              CURL_READFUNC_ABORT if aborted.
+   */
+  size_t read( char* buffer, size_t numBytes );
+
+  // C-style callback used by libcurl. The void* is the address of the Impl.
+  static size_t dataRead( char *buffer, size_t size, size_t nitems, void* userData );
+
+  mutable std::mutex mutex;
+
+  // All protected by mutex.
+  std::deque<std::string> chunks;
+  size_t frontOffset{ 0 };      //!< Bytes of chunks.front() already sent.
+  size_t numBuffered{ 0 };
+  bool finished{ false };
+  bool aborted{ false };
+  bool paused{ false };         //!< The last read returned CURL_READFUNC_PAUSE.
+  RequestHandle handle;
+};
+
+
+} // End of namespace http
+
+
+} // End of namespace url
+
+
+} // End of namespace lb
+
+
+#endif // LIB_LB_URL_HTTP_BODYSTREAMIMPL_H
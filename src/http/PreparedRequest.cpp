@@ -0,0 +1,171 @@
+/*
+    Copyright (C) 2023  Paul Fotheringham (LinuxBrickie)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "PreparedRequestImpl.h"
+
+#include <stdexcept>
+
+
+namespace lb
+{
+
+
+namespace url
+{
+
+
+namespace http
+{
+
+
+/** \brief Get a part of \a url, empty if it is not set. */
+static std::string urlPart( CURLU* url, CURLUPart what )
+{
+  std::string s;
+  char* part{ nullptr };
+  if ( curl_url_get( url, what, &part, 0 ) == CURLUE_OK )
+  {
+    s = part;
+    curl_free( part );
+  }
+  return s;
+}
+
+
+PreparedRequest::Impl::Impl( const Request& r )
+  : prototype{ r }
+  , baseUrl{ curl_url() }
+{
+  if ( !baseUrl
+    || ( curl_url_set( baseUrl, CURLUPART_URL, prototype.url.c_str(), CURLU_DEFAULT_SCHEME ) != CURLUE_OK ) )
+  {
+    curl_url_cleanup( baseUrl );
+    throw std::runtime_error( "Cannot parse URL " + prototype.url );
+  }
+
+  // The fragment is never sent so drop it.
+  curl_url_set( baseUrl, CURLUPART_FRAGMENT, nullptr, 0 );
+
+  basePath = urlPart( baseUrl, CURLUPART_PATH );
+  if ( basePath.empty() )
+  {
+    basePath = "/";
+  }
+  baseQuery = urlPart( baseUrl, CURLUPART_QUERY );
+  host = urlPart( baseUrl, CURLUPART_HOST );
+
+  for ( const auto& header : prototype.headers )
+  {
+    // Note that curl_slist_append copies the string.
+    headerList = curl_slist_append( headerList, header.c_str() );
+  }
+
+  // Only the light members are copied into each request.
+  prototype.url.clear();
+  prototype.headers.clear();
+  prototype.postUrlEncodedValues.clear();
+  prototype.mimePost = {};
+  prototype.body = {};
+  prototype.prepared = {};
+}
+
+PreparedRequest::Impl::~Impl()
+{
+  curl_slist_free_all( headerList );
+  curl_url_cleanup( baseUrl );
+}
+
+CURLU* PreparedRequest::Impl::url( const Request::Prepared& prepared ) const
+{
+  CURLU* copy{ curl_url_dup( baseUrl ) };
+  if ( !copy )
+  {
+    return nullptr;
+  }
+
+  if ( ( curl_url_set( copy, CURLUPART_PATH, prepared.path.c_str(), 0 ) != CURLUE_OK )
+    || ( curl_url_set( copy
+                     , CURLUPART_QUERY
+                     , prepared.query.empty() ? nullptr : prepared.query.c_str()
+                     , 0 ) != CURLUE_OK ) )
+  {
+    curl_url_cleanup( copy );
+    return nullptr;
+  }
+
+  return copy;
+}
+
+
+PreparedRequest::PreparedRequest( const Request& prototype )
+  : d{ std::make_shared<const Impl>( prototype ) }
+{
+}
+
+PreparedRequest::operator bool() const
+{
+  return bool( d );
+}
+
+Request PreparedRequest::create( std::string_view path, std::string_view query ) const
+{
+  if ( !d )
+  {
+    return {};
+  }
+
+  while ( !path.empty() && ( path.front() == '/' ) )
+  {
+    path.remove_prefix( 1 );
+  }
+
+  Request request{ d->prototype };
+
+  std::string& fullPath{ request.prepared.path };
+  fullPath.reserve( d->basePath.size() + path.size() + 1 );
+  fullPath += d->basePath;
+  if ( !path.empty() )
+  {
+    if ( d->basePath.back() != '/' )
+    {
+      fullPath += '/';
+    }
+    fullPath += path;
+  }
+
+  std::string& fullQuery{ request.prepared.query };
+  fullQuery.reserve( d->baseQuery.size() + query.size() + 1 );
+  fullQuery += d->baseQuery;
+  if ( !d->baseQuery.empty() && !query.empty() )
+  {
+    fullQuery += '&';
+  }
+  fullQuery += query;
+
+  request.prepared.from = *this;
+
+  return request;
+}
+
+
+} // End of namespace http
+
+
+} // End of namespace url
+
+
+} // End of namespace lb
@@ -0,0 +1,83 @@
+#ifndef LIB_LB_URL_HTTP_PREPAREDREQUESTIMPL_H
+#define LIB_LB_URL_HTTP_PREPAREDREQUESTIMPL_H
+
+/*
+    Copyright (C) 2023  Paul Fotheringham (LinuxBrickie)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// Private header
+
+#include <lb/url/http/Request.h>
+
+#include <curl/curl.h>
+
+#include <string>
+
+
+namespace lb
+{
+
+
+namespace url
+{
+
+
+namespace http
+{
+
+
+struct PreparedRequest::Impl
+{
+  explicit Impl( const Request& prototype );
+  ~Impl();
+
+  Impl( const Impl& ) = delete;
+  Impl& operator=( const Impl& ) = delete;
+
+  static const Impl* get( const PreparedRequest& prepared )
+  {
+    return prepared.d.get();
+  }
+
+  /** \brief A copy of the base URL with \a path and \a query.
+      \return Null on failure. Otherwise the caller owns the handle and must
+              free it with curl_url_cleanup.
+
+      Duplicating the already parsed base URL is cheaper than parsing a URL.
+   */
+  CURLU* url( const Request::Prepared& ) const;
+
+  Request prototype;           //!< With the URL, headers and body cleared.
+
+  CURLU* baseUrl{ nullptr };
+  std::string basePath;        //!< Always starts with '/'.
+  std::string baseQuery;
+  std::string host;            //!< For Requester::Config::hostLimits.
+
+  curl_slist* headerList{ nullptr };  //!< Never modified so shared by all requests.
+};
+
+
+} // End of namespace http
+
+
+} // End of namespace url
+
+
+} // End of namespace lb
+
+
+#endif // LIB_LB_URL_HTTP_PREPAREDREQUESTIMPL_H
@@ -0,0 +1,71 @@
+/*
+    Copyright (C) 2023  Paul Fotheringham (LinuxBrickie)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <lb/url/http/Request.h>
+
+#include <curl/curl.h>
+
+
+namespace lb
+{
+
+
+namespace url
+{
+
+
+namespace http
+{
+
+
+// static
+std::vector<int> Request::RetryPolicy::defaultRetryableCurlCodes()
+{
+  return { CURLE_COULDNT_RESOLVE_HOST
+         , CURLE_COULDNT_CONNECT
+         , CURLE_OPERATION_TIMEDOUT
+         , CURLE_GOT_NOTHING
+         , CURLE_SEND_ERROR
+         , CURLE_RECV_ERROR };
+}
+
+// static
+bool Request::Compression::isSupported( Encoding encoding )
+{
+  switch( encoding )
+  {
+  case Encoding::eNone:
+  case Encoding::eGzip:
+    return true;
+  case Encoding::eZstd:
+#ifdef LB_URL_WITH_ZSTD
+    return true;
+#else
+    return false;
+#endif
+  }
+  return false;
+}
+
+
+} // End of namespace http
+
+
+} // End of namespace url
+
+
+} // End of namespace lb
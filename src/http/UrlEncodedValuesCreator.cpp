@@ -17,7 +17,7 @@
 
 #include <lb/url/http/UrlEncodedValuesCreator.h>
 
-#include <curl/curl.h>
+#include "../UrlEscape.h"
 
 
 namespace lb
@@ -40,65 +40,65 @@ bool UrlEncodedValuesCreator::add( const Encodable& field
     return false;
   }
 
-  if ( !empty )
+  if ( !buffer.empty() )
   {
-    ss << '&';
+    buffer += '&';
   }
 
-  if ( !addEncodable( field ) )
-  {
-    return false;
-  }
+  addEncodable( field );
 
-  ss << '=';
+  buffer += '=';
 
-  if ( !addEncodable( value ) )
-  {
-    return false;
-  }
-
-  empty = false;
+  addEncodable( value );
 
   return true;
 }
 
-std::string UrlEncodedValuesCreator::str() const
+void UrlEncodedValuesCreator::reserve( size_t numBytes )
 {
-  return ss.str();
+  buffer.reserve( numBytes );
+}
+
+std::string UrlEncodedValuesCreator::str() const &
+{
+  return buffer;
+}
+
+std::string UrlEncodedValuesCreator::str() &&
+{
+  std::string s{ std::move( buffer ) };
+  buffer.clear();
+  return s;
 }
 
 void UrlEncodedValuesCreator::clear()
 {
-  ss.str( {} );
-  ss.clear();
-  empty = true;
+  buffer.clear();
+}
+
+size_t UrlEncodedValuesCreator::encodedSize( std::string_view s )
+{
+  return escapedSize( s );
 }
 
-bool UrlEncodedValuesCreator::addEncodable( const Encodable& encodable )
+char* UrlEncodedValuesCreator::encode( std::string_view s, char* out )
+{
+  return escape( s, out );
+}
+
+void UrlEncodedValuesCreator::addEncodable( const Encodable& encodable )
 {
   if ( encodable.needsEncoded )
   {
-    auto escaped
-    {
-      curl_easy_escape( nullptr /* Not used, don't panic. */
-                      , encodable.s.c_str()
-                      , encodable.s.size() )
-    };
-    if ( !escaped )
-    {
-      return false;
-    }
-
-    ss << escaped;
-
-    curl_free( escaped );
+    // Encode straight into the buffer rather than via a temporary.
+    const size_t offset{ buffer.size() };
+    buffer.resize( offset + escapedSize( encodable.s ) );
+    escape( encodable.s, buffer.data() + offset );
   }
   else
   {
-    ss << encodable.s;
+    buffer += encodable.s;
   }
-
-  return true;
 }
 
 } // End of namespace http
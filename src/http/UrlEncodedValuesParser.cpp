@@ -0,0 +1,160 @@
+/*
+    Copyright (C) 2023  Paul Fotheringham (LinuxBrickie)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <lb/url/http/UrlEncodedValuesParser.h>
+
+#include "../UrlEscape.h"
+
+
+namespace lb
+{
+
+
+namespace url
+{
+
+
+namespace http
+{
+
+
+UrlEncodedValuesParser::UrlEncodedValuesParser( std::string_view d )
+  : data{ d }
+{
+}
+
+UrlEncodedValuesParser::Iterator UrlEncodedValuesParser::begin() const
+{
+  return Iterator{ data };
+}
+
+UrlEncodedValuesParser::Iterator UrlEncodedValuesParser::end() const
+{
+  return {};
+}
+
+std::string_view UrlEncodedValuesParser::decode( std::string_view encoded, char* out )
+{
+  return { out, size_t( unescape( encoded, out ) - out ) };
+}
+
+std::string UrlEncodedValuesParser::decode( std::string_view encoded )
+{
+  std::string decoded( encoded.size(), '\0' );
+  decoded.resize( decode( encoded, decoded.data() ).size() );
+  return decoded;
+}
+
+
+UrlEncodedValuesParser::Iterator::Iterator( std::string_view data )
+  : rest{ data }
+  , atEnd{ false }
+{
+  ++*this;
+}
+
+UrlEncodedValuesParser::Iterator& UrlEncodedValuesParser::Iterator::operator++()
+{
+  while ( !rest.empty() )
+  {
+    const size_t separator{ rest.find( '&' ) };
+    const std::string_view encoded{ rest.substr( 0, separator ) };
+    rest.remove_prefix( separator == std::string_view::npos ? rest.size() : separator + 1 );
+    if ( encoded.empty() )
+    {
+      continue;
+    }
+
+    const size_t equals{ encoded.find( '=' ) };
+    pair.field = encoded.substr( 0, equals );
+    pair.value = equals == std::string_view::npos ? std::string_view{} : encoded.substr( equals + 1 );
+
+    return *this;
+  }
+
+  atEnd = true;
+  pair = {};
+  return *this;
+}
+
+UrlEncodedValuesParser::Iterator UrlEncodedValuesParser::Iterator::operator++( int )
+{
+  Iterator before{ *this };
+  ++*this;
+  return before;
+}
+
+
+UrlEncodedValuesDecoder::UrlEncodedValuesDecoder( char* data, size_t numBytes )
+  : parser{ std::string_view{ data, numBytes } }
+{
+}
+
+UrlEncodedValuesDecoder::Iterator UrlEncodedValuesDecoder::begin() const
+{
+  return Iterator{ parser.begin() };
+}
+
+UrlEncodedValuesDecoder::Iterator UrlEncodedValuesDecoder::end() const
+{
+  return Iterator{ parser.end() };
+}
+
+
+UrlEncodedValuesDecoder::Iterator::Iterator( UrlEncodedValuesParser::Iterator e )
+  : encoded{ e }
+{
+  decode();
+}
+
+UrlEncodedValuesDecoder::Iterator& UrlEncodedValuesDecoder::Iterator::operator++()
+{
+  ++encoded;
+  decode();
+  return *this;
+}
+
+UrlEncodedValuesDecoder::Iterator UrlEncodedValuesDecoder::Iterator::operator++( int )
+{
+  Iterator before{ *this };
+  ++*this;
+  return before;
+}
+
+void UrlEncodedValuesDecoder::Iterator::decode()
+{
+  if ( encoded == UrlEncodedValuesParser::Iterator{} )
+  {
+    pair = {};
+    return;
+  }
+
+  // The data was mutable on construction. Each of the field and value is
+  // decoded within its own bytes so the rest of the data is untouched.
+  const Pair& e{ *encoded };
+  pair.field = UrlEncodedValuesParser::decode( e.field, const_cast<char*>( e.field.data() ) );
+  pair.value = UrlEncodedValuesParser::decode( e.value, const_cast<char*>( e.value.data() ) );
+}
+
+
+} // End of namespace http
+
+
+} // End of namespace url
+
+
+} // End of namespace lb
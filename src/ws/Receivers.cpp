@@ -38,7 +38,7 @@ Receivers::Receivers( DataReceiver ds, ControlReceiver cs )
 }
 
 
-bool Receivers::receiveData( ConnectionID id, DataOpCode opCode, std::string message )
+bool Receivers::receiveData( ConnectionID id, DataOpCode opCode, const std::string& message )
 {
   std::scoped_lock l{ d->mutex };
   if ( d->dataReceiver )
@@ -50,7 +50,7 @@ bool Receivers::receiveData( ConnectionID id, DataOpCode opCode, std::string mes
   return false;
 }
 
-bool Receivers::receiveControl( ConnectionID id, ControlOpCode opCode, std::string payload )
+bool Receivers::receiveControl( ConnectionID id, ControlOpCode opCode, const std::string& payload )
 {
   std::scoped_lock l{ d->mutex };
   if ( d->controlReceiver )
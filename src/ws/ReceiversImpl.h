@@ -40,8 +40,8 @@ namespace ws
 struct Receivers::Impl
 {
   Impl( DataReceiver ds, ControlReceiver cs )
-    : dataReceiver{ ds }
-    , controlReceiver{ cs }
+    : dataReceiver{ std::move( ds ) }
+    , controlReceiver{ std::move( cs ) }
   {
   }
 
@@ -41,7 +41,7 @@ std::future<SendResult> Senders::sendData( DataOpCode opCode
 {
   if ( d )
   {
-    return d->sendData( opCode, message, maxFrameSize );
+    return d->sendData( opCode, message, maxFrameSize, {} );
   }
   else
   {
@@ -57,7 +57,7 @@ Senders::sendClose( encoding::websocket::closestatus::PayloadCode code
 {
   if ( d )
   {
-    return d->sendClose( code, reason );
+    return d->sendClose( code, reason, {} );
   }
   else
   {
@@ -71,7 +71,7 @@ std::future<SendResult> Senders::sendPing( std::string payload ) const
 {
   if ( d )
   {
-    return d->sendPing( payload );
+    return d->sendPing( payload, {} );
   }
   else
   {
@@ -85,7 +85,7 @@ std::future<SendResult> Senders::sendPong( std::string payload ) const
 {
   if ( d )
   {
-    return d->sendPong( payload );
+    return d->sendPong( payload, {} );
   }
   else
   {
@@ -95,6 +95,59 @@ std::future<SendResult> Senders::sendPong( std::string payload ) const
   }
 }
 
+void Senders::sendData( DataOpCode opCode
+                      , std::string message
+                      , Callback callback
+                      , size_t maxFrameSize ) const
+{
+  if ( d )
+  {
+    d->sendData( opCode, message, maxFrameSize, std::move( callback ) );
+  }
+  else if ( callback )
+  {
+    callback( SendResult::eNoImplementation );
+  }
+}
+
+void Senders::sendClose( encoding::websocket::closestatus::PayloadCode code
+                       , std::string reason
+                       , Callback callback ) const
+{
+  if ( d )
+  {
+    d->sendClose( code, reason, std::move( callback ) );
+  }
+  else if ( callback )
+  {
+    callback( SendResult::eNoImplementation );
+  }
+}
+
+void Senders::sendPing( std::string payload, Callback callback ) const
+{
+  if ( d )
+  {
+    d->sendPing( payload, std::move( callback ) );
+  }
+  else if ( callback )
+  {
+    callback( SendResult::eNoImplementation );
+  }
+}
+
+void Senders::sendPong( std::string payload, Callback callback ) const
+{
+  if ( d )
+  {
+    d->sendPong( payload, std::move( callback ) );
+  }
+  else if ( callback )
+  {
+    callback( SendResult::eNoImplementation );
+  }
+}
+
 
 } // End of namespace ws
 
@@ -22,7 +22,9 @@
 #include <lb/url/ws/Senders.h>
 
 #include <functional>
+#include <future>
 #include <mutex>
+#include <optional>
 
 
 namespace lb
@@ -39,10 +41,15 @@ namespace ws
 
 struct Senders::Impl
 {
-  using DataSender  = std::function< std::future<SendResult>( DataOpCode, const std::string&, size_t )>;
-  using CloseSender = std::function< std::future<SendResult>( encoding::websocket::closestatus::PayloadCode
-                                                            , const std::string& )>;
-  using PingSender  = std::function< std::future<SendResult>( const std::string& )>;
+  // If the send is queued then a non-empty Senders::Callback is moved from and
+  // will be given the result, in which case the returned future is invalid.
+  // If sending is no longer possible then std::nullopt is returned and the
+  // callback left as it is.
+  using Queued = std::optional< std::future<SendResult> >;
+  using DataSender  = std::function< Queued( DataOpCode, const std::string&, size_t, Callback& )>;
+  using CloseSender = std::function< Queued( encoding::websocket::closestatus::PayloadCode
+                                           , const std::string&, Callback& )>;
+  using PingSender  = std::function< Queued( const std::string&, Callback& )>;
   using PongSender = PingSender;
 
   static Senders create( DataSender ds, CloseSender cs
@@ -74,53 +81,82 @@ struct Senders::Impl
 
   std::future<SendResult> sendData( DataOpCode opCode
                                   , const std::string& message
-                                  , size_t maxFrameSize ) const
+                                  , size_t maxFrameSize, Callback callback ) const
   {
-    std::scoped_lock l{ mutex };
-    if ( dataSender )
     {
-      return dataSender( opCode, message, maxFrameSize );
+      std::scoped_lock l{ mutex };
+      if ( dataSender )
+      {
+        if ( auto queued{ dataSender( opCode, message, maxFrameSize, callback ) } )
+        {
+          return std::move( *queued );
+        }
+      }
     }
 
-    std::promise<SendResult> promise;
-    promise.set_value( SendResult::eClosed );
-    return promise.get_future();
+    return closed( callback );
   }
 
    std::future<SendResult>
      sendClose( encoding::websocket::closestatus::PayloadCode code
-              , const std::string& reason ) const
+              , const std::string& reason, Callback callback ) const
   {
-    std::scoped_lock l{ mutex };
-    if ( closeSender )
     {
-      return closeSender( code, reason );
+      std::scoped_lock l{ mutex };
+      if ( closeSender )
+      {
+        if ( auto queued{ closeSender( code, reason, callback ) } )
+        {
+          return std::move( *queued );
+        }
+      }
     }
 
-    std::promise<SendResult> promise;
-    promise.set_value( SendResult::eClosed );
-    return promise.get_future();
+    return closed( callback );
   }
 
-   std::future<SendResult> sendPing( const std::string& payload ) const
+   std::future<SendResult> sendPing( const std::string& payload, Callback callback ) const
   {
-    std::scoped_lock l{ mutex };
-    if ( pingSender )
     {
-      return pingSender( payload );
+      std::scoped_lock l{ mutex };
+      if ( pingSender )
+      {
+        if ( auto queued{ pingSender( payload, callback ) } )
+        {
+          return std::move( *queued );
+        }
+      }
     }
 
-    std::promise<SendResult> promise;
-    promise.set_value( SendResult::eClosed );
-    return promise.get_future();
+    return closed( callback );
   }
 
-   std::future<SendResult> sendPong( const std::string& payload ) const
+   std::future<SendResult> sendPong( const std::string& payload, Callback callback ) const
   {
-    std::scoped_lock l{ mutex };
-    if ( pongSender )
     {
-      return pongSender( payload );
+      std::scoped_lock l{ mutex };
+      if ( pongSender )
+      {
+        if ( auto queued{ pongSender( payload, callback ) } )
+        {
+          return std::move( *queued );
+        }
+      }
+    }
+
+    return closed( callback );
+  }
+
+  /** \brief The result of a send once sending is no longer possible.
+
+      Only called once the lock is released as the callback may send again.
+   */
+  static std::future<SendResult> closed( const Callback& callback )
+  {
+    if ( callback )
+    {
+      callback( SendResult::eClosed );
+      return {};
     }
 
     std::promise<SendResult> promise;